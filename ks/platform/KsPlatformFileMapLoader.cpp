@@ -0,0 +1,262 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <ks/KsLog.hpp>
+#include <ks/platform/KsPlatformFileMapLoader.hpp>
+
+#ifdef KS_ENV_LINUX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ks
+{
+    namespace gui
+    {
+        // ============================================================= //
+        // ============================================================= //
+
+        MappedFile::MappedFile(std::string path, u8 const * data, u64 size) :
+            m_path(std::move(path)),
+            m_data(data),
+            m_size(size)
+        {
+
+        }
+
+        MappedFile::~MappedFile()
+        {
+#ifdef KS_ENV_LINUX
+            if(m_data) {
+                munmap(const_cast<u8*>(m_data),m_size);
+            }
+#endif
+        }
+
+        std::string const & MappedFile::GetPath() const
+        {
+            return m_path;
+        }
+
+        u8 const * MappedFile::GetData() const
+        {
+            return m_data;
+        }
+
+        u64 MappedFile::GetSize() const
+        {
+            return m_size;
+        }
+
+        // ============================================================= //
+        // ============================================================= //
+
+        FileMapLoader::FileMapLoader(Settings const &settings) :
+            m_settings(settings),
+            m_next_id(1),
+            m_current_id(0),
+            m_stop(false)
+        {
+            m_thread = std::thread(&FileMapLoader::run,this);
+        }
+
+        FileMapLoader::~FileMapLoader()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stop = true;
+                m_list_requests.clear();
+            }
+            m_cv.notify_one();
+            m_thread.join();
+        }
+
+        Id FileMapLoader::Load(std::string const &path)
+        {
+            Id request_id;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                request_id = m_next_id++;
+                m_list_requests.push_back(Request{request_id,path});
+            }
+            m_cv.notify_one();
+
+            return request_id;
+        }
+
+        void FileMapLoader::Cancel(Id request_id)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            auto it = std::find_if(m_list_requests.begin(),
+                                   m_list_requests.end(),
+                                   [request_id](Request const &request) {
+                                       return (request.id == request_id);
+                                   });
+
+            if(it != m_list_requests.end()) {
+                m_list_requests.erase(it);
+            }
+            else if(request_id == m_current_id) {
+                m_list_cancelled.push_back(request_id);
+            }
+        }
+
+        bool FileMapLoader::getCancelled(Id request_id)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if(m_stop) {
+                return true;
+            }
+
+            auto it = std::find(m_list_cancelled.begin(),
+                                m_list_cancelled.end(),
+                                request_id);
+
+            return (it != m_list_cancelled.end());
+        }
+
+        void FileMapLoader::run()
+        {
+            for(;;) {
+                Request request;
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_cv.wait(lock,[this](){
+                        return (m_stop || !m_list_requests.empty());
+                    });
+
+                    if(m_stop) {
+                        break;
+                    }
+
+                    request = m_list_requests.front();
+                    m_list_requests.pop_front();
+                    m_current_id = request.id;
+                    m_list_cancelled.clear();
+                }
+
+                load(request);
+
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_current_id = 0;
+            }
+        }
+
+        void FileMapLoader::load(Request const &request)
+        {
+#ifdef KS_ENV_LINUX
+            int const fd = open(request.path.c_str(),O_RDONLY|O_CLOEXEC);
+            if(fd < 0) {
+                signal_failed.Emit(request.id,request.path,std::strerror(errno));
+                return;
+            }
+
+            struct stat file_stat;
+            if(fstat(fd,&file_stat) != 0) {
+                std::string const err_msg = std::strerror(errno);
+                close(fd);
+                signal_failed.Emit(request.id,request.path,err_msg);
+                return;
+            }
+
+            if(!S_ISREG(file_stat.st_mode)) {
+                close(fd);
+                signal_failed.Emit(request.id,request.path,"Not a regular file");
+                return;
+            }
+
+            u64 const size = file_stat.st_size;
+            if(size == 0) {
+                // Empty files can't be mapped
+                close(fd);
+                if(getCancelled(request.id)) {
+                    signal_failed.Emit(request.id,request.path,"Cancelled");
+                    return;
+                }
+                signal_progress.Emit(request.id,0,0);
+                signal_loaded.Emit(request.id,
+                                   make_shared<MappedFile const>(
+                                       request.path,nullptr,0));
+                return;
+            }
+
+            void* data = mmap(nullptr,size,PROT_READ,MAP_PRIVATE,fd,0);
+            close(fd);
+
+            if(data == MAP_FAILED) {
+                signal_failed.Emit(request.id,request.path,std::strerror(errno));
+                return;
+            }
+
+            // Owns the mapping from here on, so it's unmapped
+            // if the request fails
+            auto file = make_shared<MappedFile const>(
+                        request.path,static_cast<u8 const *>(data),size);
+
+            madvise(data,size,MADV_SEQUENTIAL);
+
+            if(m_settings.prefault) {
+                u64 const page_size = sysconf(_SC_PAGESIZE);
+                u64 const chunk_size =
+                        std::max(page_size,m_settings.chunk_size)/page_size*page_size;
+
+                u8 const * bytes = file->GetData();
+                for(u64 offset=0; offset < size; offset += chunk_size) {
+                    if(getCancelled(request.id)) {
+                        signal_failed.Emit(request.id,request.path,"Cancelled");
+                        return;
+                    }
+
+                    u64 const length = std::min(chunk_size,size-offset);
+                    madvise(const_cast<u8*>(bytes+offset),length,MADV_WILLNEED);
+
+                    // Touching one byte per page faults the
+                    // chunk in on this thread
+                    u8 volatile sink = 0;
+                    for(u64 i=0; i < length; i += page_size) {
+                        sink = sink+bytes[offset+i];
+                    }
+                    (void)sink;
+
+                    signal_progress.Emit(request.id,offset+length,size);
+                }
+            }
+            else {
+                signal_progress.Emit(request.id,size,size);
+            }
+
+            // Without prefaulting nothing above checks, and a
+            // cancelled request must not be reported as loaded
+            if(getCancelled(request.id)) {
+                signal_failed.Emit(request.id,request.path,"Cancelled");
+                return;
+            }
+
+            signal_loaded.Emit(request.id,file);
+#else
+            signal_failed.Emit(request.id,request.path,
+                               "Mapping files is unsupported on this platform");
+#endif
+        }
+    }
+}
@@ -0,0 +1,142 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef KS_PLATFORM_FILE_MAP_LOADER_HPP
+#define KS_PLATFORM_FILE_MAP_LOADER_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <ks/KsGlobal.hpp>
+
+namespace ks
+{
+    namespace gui
+    {
+        // MappedFile
+        // * A read only view of a whole file mapped into memory;
+        //   the data is read straight from the page cache without
+        //   being copied
+        // * The file stays mapped until the last reference to
+        //   the MappedFile is released
+        // * If the file is truncated while it's mapped, reading
+        //   the pages past its new end raises SIGBUS and kills the
+        //   app unless it handles the signal. Files dropped by the
+        //   user can be changed by other processes at any time, so
+        //   copy out anything that must stay valid, or only map
+        //   files the app controls
+        class MappedFile final
+        {
+        public:
+            MappedFile(std::string path, u8 const * data, u64 size);
+            ~MappedFile();
+
+            MappedFile(MappedFile const &) = delete;
+            MappedFile& operator=(MappedFile const &) = delete;
+
+            std::string const & GetPath() const;
+            u8 const * GetData() const;
+            u64 GetSize() const;
+
+        private:
+            std::string const m_path;
+            u8 const * const m_data;
+            u64 const m_size;
+        };
+
+        // FileMapLoader
+        // * Maps files into memory on a background thread so that
+        //   loading large files (ie. dropped onto a window) never
+        //   blocks the thread that requested them
+        // * After mapping, the file's pages are read in on the
+        //   background thread in chunks of Settings::chunk_size, so
+        //   the app doesn't stall on page faults when it first
+        //   reads the data; signal_progress is emitted after each
+        //   chunk
+        // * Requests are handled one at a time in the order they
+        //   were made
+        // * The signals are emitted from the loader's thread;
+        //   connect with a queued connection to the app's event
+        //   loop to receive them there
+        // * Mapping is only available on Linux; the other
+        //   platforms fail every request
+        class FileMapLoader final
+        {
+        public:
+            struct Settings
+            {
+                u64 chunk_size{64*1024*1024};
+
+                // Whether to read the pages in before the file
+                // is handed over
+                bool prefault{true};
+            };
+
+            FileMapLoader(Settings const &settings);
+
+            // Cancels pending requests and waits for the
+            // current one to stop
+            ~FileMapLoader();
+
+            // * Any thread
+            // * Returns an id for the request that's passed
+            //   to the signals
+            Id Load(std::string const &path);
+
+            // * Any thread
+            // * A pending request is dropped without any signal,
+            //   one that's in progress is failed with "Cancelled"
+            //   and one that's finished is unaffected
+            void Cancel(Id request_id);
+
+            // (request id, bytes read in, total bytes)
+            Signal<Id,u64,u64> signal_progress;
+            Signal<Id,shared_ptr<MappedFile const>> signal_loaded;
+
+            // (request id, path, error)
+            Signal<Id,std::string,std::string> signal_failed;
+
+        private:
+            struct Request
+            {
+                Id id;
+                std::string path;
+            };
+
+            void load(Request const &request);
+            bool getCancelled(Id request_id);
+            void run();
+
+            Settings const m_settings;
+
+            std::mutex m_mutex;
+            std::condition_variable m_cv;
+            std::deque<Request> m_list_requests;
+            std::vector<Id> m_list_cancelled;
+            Id m_next_id;
+            Id m_current_id;
+            bool m_stop;
+
+            std::thread m_thread;
+        };
+    }
+}
+
+#endif // KS_PLATFORM_FILE_MAP_LOADER_HPP
@@ -0,0 +1,475 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <cstdio>
+#include <cstring>
+
+#include <ks/KsLog.hpp>
+#include <ks/gui/KsGuiPlatform.hpp>
+#include <ks/platform/KsPlatformFrameCapture.hpp>
+
+#ifdef KS_ENV_LINUX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ks
+{
+    namespace gui
+    {
+        // ============================================================= //
+        // ============================================================= //
+
+        FrameCaptureFileSink::FrameCaptureFileSink(std::string path_prefix,
+                                                   uint buffer_count,
+                                                   ThreadQoS const &qos) :
+            m_path_prefix(std::move(path_prefix)),
+            m_qos(qos),
+            m_stop(false)
+        {
+            for(uint i=0; i < buffer_count; i++) {
+                m_list_free.emplace_back(new Buffer());
+            }
+
+            m_thread = std::thread(&FrameCaptureFileSink::writeFrames,this);
+        }
+
+        FrameCaptureFileSink::~FrameCaptureFileSink()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stop = true;
+            }
+            m_cv.notify_one();
+            m_thread.join();
+        }
+
+        u8* FrameCaptureFileSink::AcquireFrame(CaptureFrameInfo const &info)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if(m_list_free.empty()) {
+                    return nullptr;
+                }
+
+                m_acquired = std::move(m_list_free.front());
+                m_list_free.pop_front();
+            }
+
+            m_acquired->info = info;
+            m_acquired->data.resize(info.size_bytes);
+            return m_acquired->data.data();
+        }
+
+        void FrameCaptureFileSink::CommitFrame(CaptureFrameInfo const &)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_list_ready.push_back(std::move(m_acquired));
+            }
+            m_cv.notify_one();
+        }
+
+        void FrameCaptureFileSink::writeFrames()
+        {
+            // Failures are logged by Apply
+            ThreadQoS::Apply(m_qos);
+
+            for(;;) {
+                unique_ptr<Buffer> buffer;
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_cv.wait(lock,[this](){
+                        return (m_stop || !m_list_ready.empty());
+                    });
+
+                    if(m_list_ready.empty()) {
+                        // Stopped and all frames written
+                        return;
+                    }
+
+                    buffer = std::move(m_list_ready.front());
+                    m_list_ready.pop_front();
+                }
+
+                std::string const path =
+                        m_path_prefix+std::to_string(buffer->info.index)+".rgba";
+
+                FILE* file = std::fopen(path.c_str(),"wb");
+                if(file == nullptr) {
+                    LOG.Warn() << "FrameCapture: Failed to open " << path;
+                }
+                else {
+                    std::fwrite(buffer->data.data(),1,buffer->data.size(),file);
+                    std::fclose(file);
+                }
+
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_list_free.push_back(std::move(buffer));
+            }
+        }
+
+        // ============================================================= //
+        // ============================================================= //
+
+#ifdef KS_ENV_LINUX
+        FrameCaptureShmSink::FrameCaptureShmSink(std::string name,
+                                                 uint slot_count,
+                                                 uint max_frame_bytes) :
+            m_name(std::move(name)),
+            m_slot_count(slot_count),
+            m_max_frame_bytes(max_frame_bytes),
+            m_data(nullptr),
+            m_header(nullptr),
+            m_acquired(nullptr)
+        {
+            // Keep pixel data 64-byte aligned
+            u64 const header_size = (sizeof(ShmHeader)+63)/64*64;
+            u64 const slot_header_size = (sizeof(ShmSlot)+63)/64*64;
+            m_slot_stride = slot_header_size+(u64(max_frame_bytes)+63)/64*64;
+            m_size_bytes = header_size+m_slot_stride*slot_count;
+
+            int fd = shm_open(m_name.c_str(),O_CREAT|O_RDWR,0600);
+            if(fd < 0) {
+                throw WindowSettingFailed(
+                            "FrameCapture: shm_open failed for "+m_name);
+            }
+
+            if(ftruncate(fd,m_size_bytes) != 0) {
+                close(fd);
+                shm_unlink(m_name.c_str());
+                throw WindowSettingFailed(
+                            "FrameCapture: Failed to size shared memory");
+            }
+
+            void* data = mmap(nullptr,m_size_bytes,
+                              PROT_READ|PROT_WRITE,MAP_SHARED,fd,0);
+            close(fd);
+
+            if(data == MAP_FAILED) {
+                shm_unlink(m_name.c_str());
+                throw WindowSettingFailed(
+                            "FrameCapture: Failed to map shared memory");
+            }
+
+            m_data = static_cast<u8*>(data);
+            m_header = new (m_data) ShmHeader();
+            m_header->magic = 0x4346534B;
+            m_header->slot_count = m_slot_count;
+            m_header->max_frame_bytes = m_max_frame_bytes;
+            m_header->slot_stride = m_slot_stride;
+            m_header->write_count.store(0,std::memory_order_relaxed);
+
+            for(uint i=0; i < m_slot_count; i++) {
+                new (m_data+header_size+m_slot_stride*i) ShmSlot();
+            }
+
+            // Move the data pointer to the first slot
+            m_data += header_size;
+        }
+
+        FrameCaptureShmSink::~FrameCaptureShmSink()
+        {
+            munmap(reinterpret_cast<u8*>(m_header),m_size_bytes);
+            shm_unlink(m_name.c_str());
+        }
+
+        u8* FrameCaptureShmSink::AcquireFrame(CaptureFrameInfo const &info)
+        {
+            if(info.size_bytes > m_max_frame_bytes) {
+                return nullptr;
+            }
+
+            u64 const write_count =
+                    m_header->write_count.load(std::memory_order_relaxed);
+
+            u8* slot_data = m_data+m_slot_stride*(write_count%m_slot_count);
+            m_acquired = reinterpret_cast<ShmSlot*>(slot_data);
+
+            // Odd while being written
+            u64 const seq = m_acquired->seq.load(std::memory_order_relaxed);
+            m_acquired->seq.store(seq+1,std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+
+            return slot_data+(m_slot_stride-((m_max_frame_bytes+63)/64*64));
+        }
+
+        void FrameCaptureShmSink::CommitFrame(CaptureFrameInfo const &info)
+        {
+            m_acquired->index = info.index;
+            m_acquired->timestamp_ns =
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        info.timestamp.time_since_epoch()).count();
+            m_acquired->width = info.width;
+            m_acquired->height = info.height;
+
+            u64 const seq = m_acquired->seq.load(std::memory_order_relaxed);
+            m_acquired->seq.store(seq+1,std::memory_order_release);
+            m_header->write_count.fetch_add(1,std::memory_order_release);
+            m_acquired = nullptr;
+        }
+#endif
+
+        // ============================================================= //
+        // ============================================================= //
+
+        FrameCapture::FrameCapture(shared_ptr<FrameCaptureSink> sink,
+                                   uint ring_size,
+                                   ThreadQoS const &qos) :
+            m_sink(sink),
+            m_qos(qos),
+            m_list_slots(ring_size),
+            m_write(0),
+            m_read(0),
+            m_unmap(0),
+            m_gl_forgotten(false),
+            m_stop(false),
+            m_captured(0),
+            m_dropped(0)
+        {
+            for(auto& slot : m_list_slots) {
+                glGenBuffers(1,&slot.pbo);
+            }
+
+            m_thread = std::thread(&FrameCapture::copyFrames,this);
+        }
+
+        FrameCapture::~FrameCapture()
+        {
+            // Deliver what has already completed but don't
+            // wait on anything still in flight
+            if(!m_gl_forgotten) {
+                deliverCompleted();
+            }
+
+            // The copy thread finishes the frames it was
+            // given, which is at most the ring size
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stop = true;
+            }
+            m_cv.notify_one();
+            m_thread.join();
+
+            if(m_gl_forgotten) {
+                return;
+            }
+
+            unmapCopied();
+
+            for(auto& slot : m_list_slots) {
+                if(slot.fence) {
+                    glDeleteSync(slot.fence);
+                }
+                glDeleteBuffers(1,&slot.pbo);
+            }
+        }
+
+        void FrameCapture::Capture(uint width, uint height)
+        {
+            deliverCompleted();
+
+            if(m_write-m_unmap == m_list_slots.size()) {
+                // Every buffer is still in flight or being copied
+                m_dropped++;
+                return;
+            }
+
+            Slot& slot = m_list_slots[m_write%m_list_slots.size()];
+
+            slot.info.index = m_write;
+            slot.info.timestamp = std::chrono::high_resolution_clock::now();
+            slot.info.width = width;
+            slot.info.height = height;
+            slot.info.size_bytes = width*height*4;
+
+            // Read from the default framebuffer's back buffer
+            // without disturbing the app's bindings or pack state
+            GLint prev_read_fbo = 0;
+            GLint prev_pack_pbo = 0;
+            GLint prev_pack_alignment = 4;
+            glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING,&prev_read_fbo);
+            glGetIntegerv(GL_PIXEL_PACK_BUFFER_BINDING,&prev_pack_pbo);
+            glGetIntegerv(GL_PACK_ALIGNMENT,&prev_pack_alignment);
+            glBindFramebuffer(GL_READ_FRAMEBUFFER,0);
+
+            glBindBuffer(GL_PIXEL_PACK_BUFFER,slot.pbo);
+            if(slot.pbo_size != slot.info.size_bytes) {
+                glBufferData(GL_PIXEL_PACK_BUFFER,
+                             slot.info.size_bytes,
+                             nullptr,
+                             GL_STREAM_READ);
+                slot.pbo_size = slot.info.size_bytes;
+            }
+
+            glPixelStorei(GL_PACK_ALIGNMENT,4);
+            glReadPixels(0,0,width,height,GL_RGBA,GL_UNSIGNED_BYTE,nullptr);
+            slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE,0);
+
+            glPixelStorei(GL_PACK_ALIGNMENT,prev_pack_alignment);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER,prev_pack_pbo);
+            glBindFramebuffer(GL_READ_FRAMEBUFFER,prev_read_fbo);
+
+            m_write++;
+        }
+
+        FrameCapture::Stats FrameCapture::GetStats() const
+        {
+            return Stats{m_captured.load(),m_dropped.load()};
+        }
+
+        ThreadQoS::Result FrameCapture::GetQoSResult() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_qos_result;
+        }
+
+        void FrameCapture::ForgetGLObjects()
+        {
+            m_gl_forgotten = true;
+        }
+
+        void FrameCapture::deliverCompleted()
+        {
+            // Free the slots the copy thread is done with first
+            // so they can take this frame
+            unmapCopied();
+
+            GLint prev_pack_pbo = 0;
+            glGetIntegerv(GL_PIXEL_PACK_BUFFER_BINDING,&prev_pack_pbo);
+
+            // Frames are delivered in order so stop at
+            // the first one that hasn't completed
+            bool queued = false;
+            while(m_read != m_write) {
+                uint const index = m_read%m_list_slots.size();
+                Slot& slot = m_list_slots[index];
+
+                GLenum const status = glClientWaitSync(slot.fence,0,0);
+                if(status != GL_ALREADY_SIGNALED &&
+                   status != GL_CONDITION_SATISFIED) {
+                    break;
+                }
+
+                glDeleteSync(slot.fence);
+                slot.fence = nullptr;
+
+                // Mapping a completed readback doesn't wait on the
+                // gpu; the copy itself is left to the copy thread
+                glBindBuffer(GL_PIXEL_PACK_BUFFER,slot.pbo);
+                slot.mapped = static_cast<u8 const *>(
+                            glMapBufferRange(GL_PIXEL_PACK_BUFFER,
+                                             0,
+                                             slot.info.size_bytes,
+                                             GL_MAP_READ_BIT));
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    slot.copied = false;
+                    m_list_copy.push_back(index);
+                }
+
+                queued = true;
+                m_read++;
+            }
+
+            glBindBuffer(GL_PIXEL_PACK_BUFFER,prev_pack_pbo);
+
+            if(queued) {
+                m_cv.notify_one();
+            }
+        }
+
+        void FrameCapture::unmapCopied()
+        {
+            GLint prev_pack_pbo = 0;
+            bool unmapped = false;
+
+            while(m_unmap != m_read) {
+                Slot& slot = m_list_slots[m_unmap%m_list_slots.size()];
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    if(!slot.copied) {
+                        break;
+                    }
+                }
+
+                if(slot.mapped) {
+                    if(!unmapped) {
+                        glGetIntegerv(GL_PIXEL_PACK_BUFFER_BINDING,
+                                      &prev_pack_pbo);
+                        unmapped = true;
+                    }
+                    glBindBuffer(GL_PIXEL_PACK_BUFFER,slot.pbo);
+                    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+                    slot.mapped = nullptr;
+                }
+
+                m_unmap++;
+            }
+
+            if(unmapped) {
+                glBindBuffer(GL_PIXEL_PACK_BUFFER,prev_pack_pbo);
+            }
+        }
+
+        void FrameCapture::copyFrames()
+        {
+            {
+                ThreadQoS::Result qos_result = ThreadQoS::Apply(m_qos);
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_qos_result = std::move(qos_result);
+            }
+
+            for(;;) {
+                Slot* slot;
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_cv.wait(lock,[this](){
+                        return (m_stop || !m_list_copy.empty());
+                    });
+
+                    if(m_list_copy.empty()) {
+                        // Stopped and all frames copied
+                        return;
+                    }
+
+                    slot = &(m_list_slots[m_list_copy.front()]);
+                    m_list_copy.pop_front();
+                }
+
+                // A failed map is counted as a drop
+                u8* dst = nullptr;
+                if(slot->mapped) {
+                    dst = m_sink->AcquireFrame(slot->info);
+                }
+
+                if(dst) {
+                    std::memcpy(dst,slot->mapped,slot->info.size_bytes);
+                    m_sink->CommitFrame(slot->info);
+                    m_captured++;
+                }
+                else {
+                    m_dropped++;
+                }
+
+                std::lock_guard<std::mutex> lock(m_mutex);
+                slot->copied = true;
+            }
+        }
+    }
+}
@@ -0,0 +1,267 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef KS_PLATFORM_FRAME_CAPTURE_HPP
+#define KS_PLATFORM_FRAME_CAPTURE_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <ks/gl/KsGLConfig.hpp>
+#include <ks/KsGlobal.hpp>
+#include <ks/platform/KsPlatformOpts.hpp>
+#include <ks/platform/sdl/KsGuiThreadQoSSDL.hpp>
+
+namespace ks
+{
+    namespace gui
+    {
+        // Frames are tightly packed RGBA8 rows, bottom row first
+        // (the order glReadPixels returns them in)
+        struct CaptureFrameInfo
+        {
+            u64 index;
+            TimePoint timestamp;
+            uint width;
+            uint height;
+            uint size_bytes;
+        };
+
+        // ============================================================= //
+        // ============================================================= //
+
+        // FrameCaptureSink
+        // * Receives captured frames from a FrameCapture
+        // * Both functions are called from the FrameCapture's copy
+        //   thread, which copies one frame at a time; slow work
+        //   (ie. file io) should be handed off to another thread
+        //   so completed frames don't back up and get dropped
+        class FrameCaptureSink
+        {
+        public:
+            virtual ~FrameCaptureSink() = default;
+
+            // Returns the memory to copy the frame into or
+            // nullptr to drop the frame
+            virtual u8* AcquireFrame(CaptureFrameInfo const &info) = 0;
+
+            // Called after a frame returned by AcquireFrame
+            // has been filled
+            virtual void CommitFrame(CaptureFrameInfo const &info) = 0;
+        };
+
+        // ============================================================= //
+        // ============================================================= //
+
+        // FrameCaptureFileSink
+        // * Writes each frame to its own raw file named
+        //   <path_prefix><frame index>.rgba on a writer thread
+        // * Frames are dropped if all buffers are waiting
+        //   to be written
+        // * qos is applied to the writer thread when it starts
+        class FrameCaptureFileSink final : public FrameCaptureSink
+        {
+        public:
+            FrameCaptureFileSink(std::string path_prefix,
+                                 uint buffer_count=4,
+                                 ThreadQoS const &qos=ThreadQoS());
+
+            ~FrameCaptureFileSink();
+
+            u8* AcquireFrame(CaptureFrameInfo const &info);
+            void CommitFrame(CaptureFrameInfo const &info);
+
+        private:
+            struct Buffer
+            {
+                CaptureFrameInfo info;
+                std::vector<u8> data;
+            };
+
+            void writeFrames();
+
+            std::string const m_path_prefix;
+            ThreadQoS const m_qos;
+
+            std::mutex m_mutex;
+            std::condition_variable m_cv;
+            bool m_stop;
+            std::deque<unique_ptr<Buffer>> m_list_free;
+            std::deque<unique_ptr<Buffer>> m_list_ready;
+
+            // Only accessed from the render thread
+            unique_ptr<Buffer> m_acquired;
+
+            std::thread m_thread;
+        };
+
+        // ============================================================= //
+        // ============================================================= //
+
+#ifdef KS_ENV_LINUX
+        // FrameCaptureShmSink
+        // * Writes frames into a ring of slots in a POSIX shared
+        //   memory object that other local processes can map
+        //   and read without any further copies
+        // * Layout: a ShmHeader followed by slot_count slots, each
+        //   a ShmSlot followed by max_frame_bytes of pixels
+        // * A reader should read write_count, pick the slot
+        //   (write_count-1)%slot_count and check that the slot's
+        //   seq is even and unchanged after copying, as with a
+        //   seqlock
+        class FrameCaptureShmSink final : public FrameCaptureSink
+        {
+        public:
+            struct ShmHeader
+            {
+                u32 magic; // 'KSFC'
+                u32 slot_count;
+                u64 max_frame_bytes;
+                u64 slot_stride;
+                std::atomic<u64> write_count;
+            };
+
+            struct ShmSlot
+            {
+                std::atomic<u64> seq;
+                u64 index;
+                s64 timestamp_ns;
+                u32 width;
+                u32 height;
+            };
+
+            FrameCaptureShmSink(std::string name,
+                                uint slot_count,
+                                uint max_frame_bytes);
+
+            ~FrameCaptureShmSink();
+
+            u8* AcquireFrame(CaptureFrameInfo const &info);
+            void CommitFrame(CaptureFrameInfo const &info);
+
+        private:
+            std::string const m_name;
+            uint const m_slot_count;
+            uint const m_max_frame_bytes;
+            u64 m_slot_stride;
+            u64 m_size_bytes;
+            u8* m_data;
+            ShmHeader* m_header;
+            ShmSlot* m_acquired;
+        };
+#endif
+
+        // ============================================================= //
+        // ============================================================= //
+
+        // FrameCapture
+        // * Reads back the default framebuffer into a ring of
+        //   pixel buffer objects, each guarded by a fence
+        // * A frame is only mapped once its fence has signaled,
+        //   which is checked without waiting on later frames. The
+        //   mapped buffer is handed to a copy thread that copies it
+        //   into the sink, and it's unmapped on the render thread
+        //   once the copy is done
+        // * If every buffer is still in flight or being copied the
+        //   new frame is dropped rather than stalling the render
+        //   thread, so the copy work is bounded by the ring size
+        // * qos is applied to the copy thread when it starts
+        // * All functions except GetStats must be called from the
+        //   thread the window's context is current on
+        class FrameCapture final
+        {
+        public:
+            struct Stats
+            {
+                u64 captured;
+                u64 dropped;
+            };
+
+            FrameCapture(shared_ptr<FrameCaptureSink> sink,
+                         uint ring_size=3,
+                         ThreadQoS const &qos=ThreadQoS());
+
+            ~FrameCapture();
+
+            // Issues a readback of the current back buffer and
+            // delivers any earlier readbacks that have completed
+            void Capture(uint width, uint height);
+
+            // Any thread
+            Stats GetStats() const;
+
+            // * Any thread
+            // * The result of applying qos; ok until the thread
+            //   has started
+            ThreadQoS::Result GetQoSResult() const;
+
+            // * Drops the GL objects without deleting or unmapping
+            //   them, for when their context can't be made current
+            // * The objects are leaked; the destructor still waits
+            //   for the copy thread but makes no GL calls
+            void ForgetGLObjects();
+
+        private:
+            struct Slot
+            {
+                GLuint pbo{0};
+                GLsync fence{nullptr};
+                uint pbo_size{0};
+                CaptureFrameInfo info;
+
+                // Set while the pbo is mapped for the copy thread
+                u8 const * mapped{nullptr};
+
+                // Set by the copy thread, guarded by m_mutex
+                bool copied{false};
+            };
+
+            void deliverCompleted();
+            void unmapCopied();
+            void copyFrames();
+
+            shared_ptr<FrameCaptureSink> m_sink;
+            ThreadQoS const m_qos;
+            std::vector<Slot> m_list_slots;
+
+            // Slots are used in order; m_unmap is the oldest slot
+            // handed to the copy thread and m_read is the oldest
+            // slot with a readback in flight
+            u64 m_write;
+            u64 m_read;
+            u64 m_unmap;
+            bool m_gl_forgotten;
+
+            mutable std::mutex m_mutex;
+            std::condition_variable m_cv;
+            bool m_stop;
+            std::deque<uint> m_list_copy;
+            ThreadQoS::Result m_qos_result;
+
+            std::atomic<u64> m_captured;
+            std::atomic<u64> m_dropped;
+
+            std::thread m_thread;
+        };
+    }
+}
+
+#endif // KS_PLATFORM_FRAME_CAPTURE_HPP
@@ -0,0 +1,146 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef KS_PLATFORM_MPSC_QUEUE_HPP
+#define KS_PLATFORM_MPSC_QUEUE_HPP
+
+#include <atomic>
+
+#include <ks/KsGlobal.hpp>
+
+namespace ks
+{
+    // MPSCQueue
+    // * A bounded queue with any number of producer threads
+    //   and a single consumer thread
+    // * Neither side takes a lock; producers claim a cell with
+    //   a single compare and swap, and each cell's sequence
+    //   number tells the consumer when its value is written
+    //   (after D. Vyukov's bounded queue)
+    // * Push fails instead of waiting when the queue is full
+    // * Values from one producer are popped in the order they
+    //   were pushed
+    // * capacity is rounded up to a power of two
+    template<typename T>
+    class MPSCQueue final
+    {
+    public:
+        MPSCQueue(uint capacity) :
+            m_mask(getCapacity(capacity)-1),
+            m_list_cells(new Cell[m_mask+1]),
+            m_tail(0),
+            m_padding(),
+            m_head(0)
+        {
+            for(u64 i=0; i <= m_mask; i++) {
+                m_list_cells[i].seq.store(i,std::memory_order_relaxed);
+            }
+        }
+
+        MPSCQueue(MPSCQueue const &) = delete;
+        MPSCQueue& operator=(MPSCQueue const &) = delete;
+
+        // Any thread
+        bool Push(T const &value)
+        {
+            u64 pos = m_tail.load(std::memory_order_relaxed);
+            for(;;) {
+                Cell& cell = m_list_cells[pos & m_mask];
+                u64 const seq = cell.seq.load(std::memory_order_acquire);
+                s64 const diff = static_cast<s64>(seq-pos);
+
+                if(diff == 0) {
+                    // The cell is free for this position
+                    if(m_tail.compare_exchange_weak(
+                           pos,pos+1,std::memory_order_relaxed)) {
+                        cell.value = value;
+                        cell.seq.store(pos+1,std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if(diff < 0) {
+                    // The consumer hasn't popped the value that was
+                    // written a lap ago
+                    return false;
+                }
+                else {
+                    // Another producer claimed the position
+                    pos = m_tail.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        // Consumer thread only
+        bool Pop(T &value)
+        {
+            Cell& cell = m_list_cells[m_head & m_mask];
+            u64 const seq = cell.seq.load(std::memory_order_acquire);
+            if(seq != m_head+1) {
+                // Empty, or a producer that claimed the cell
+                // hasn't finished writing it
+                return false;
+            }
+
+            value = cell.value;
+
+            // Free the cell for the position a lap ahead
+            cell.seq.store(m_head+m_mask+1,std::memory_order_release);
+            m_head++;
+            return true;
+        }
+
+        // Consumer thread only
+        bool GetEmpty() const
+        {
+            Cell const &cell = m_list_cells[m_head & m_mask];
+            return (cell.seq.load(std::memory_order_acquire) != m_head+1);
+        }
+
+        uint GetCapacity() const
+        {
+            return m_mask+1;
+        }
+
+    private:
+        struct Cell
+        {
+            std::atomic<u64> seq;
+            T value{};
+        };
+
+        static u64 getCapacity(uint capacity)
+        {
+            u64 pow2 = 2;
+            while(pow2 < capacity) {
+                pow2 <<= 1;
+            }
+            return pow2;
+        }
+
+        u64 const m_mask;
+        unique_ptr<Cell[]> m_list_cells;
+
+        std::atomic<u64> m_tail;
+
+        // Keeps the consumer's index off of the cache
+        // line the producers contend on
+        u8 m_padding[64];
+
+        u64 m_head;
+    };
+}
+
+#endif // KS_PLATFORM_MPSC_QUEUE_HPP
@@ -22,5 +22,16 @@
 // Currently we use SDL2 for all platforms
 #define KS_ENV_SDL2 1
 
+// If KS_PLATFORM_STATIC_DISPATCH is defined (ie. with
+// CONFIG += ks_platform_static_dispatch), the SDL platform
+// classes are declared final so that calls made through
+// the concrete types don't need to go through the vtable;
+// see KsPlatformStaticDispatch.hpp
+#ifdef KS_PLATFORM_STATIC_DISPATCH
+    #define KS_PLATFORM_FINAL final
+#else
+    #define KS_PLATFORM_FINAL
+#endif
+
 #endif // KS_PLATFORM_OPTIONS_HPP
  
@@ -0,0 +1,216 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <algorithm>
+#include <cmath>
+
+#include <ks/KsLog.hpp>
+#include <ks/platform/KsPlatformResolutionScaler.hpp>
+
+namespace ks
+{
+    namespace gui
+    {
+        namespace
+        {
+            // Weight of the newest frame in the averaged timings
+            float const k_timing_weight = 0.1f;
+
+            // Intervals up to this much over budget are
+            // treated as jitter rather than an overrun
+            float const k_overrun_tolerance = 1.1f;
+        }
+
+        ResolutionScaler::ResolutionScaler(Settings const &settings,
+                                           uint drawable_width,
+                                           uint drawable_height) :
+            m_settings(settings),
+            m_fbo(0),
+            m_color_rb(0),
+            m_depth_stencil_rb(0),
+            m_gl_forgotten(false),
+            m_render_width(0),
+            m_render_height(0),
+            m_scale(settings.max_scale),
+            m_frame_start(std::chrono::high_resolution_clock::now()),
+            m_have_timing(false),
+            m_avg_interval_us(0.0f),
+            m_avg_work_us(0.0f),
+            m_headroom_frames(0)
+        {
+            glGenFramebuffers(1,&m_fbo);
+            glGenRenderbuffers(1,&m_color_rb);
+            glGenRenderbuffers(1,&m_depth_stencil_rb);
+
+            resize(drawable_width,drawable_height);
+
+            glBindFramebuffer(GL_FRAMEBUFFER,m_fbo);
+            glFramebufferRenderbuffer(GL_FRAMEBUFFER,
+                                      GL_COLOR_ATTACHMENT0,
+                                      GL_RENDERBUFFER,
+                                      m_color_rb);
+            glFramebufferRenderbuffer(GL_FRAMEBUFFER,
+                                      GL_DEPTH_STENCIL_ATTACHMENT,
+                                      GL_RENDERBUFFER,
+                                      m_depth_stencil_rb);
+
+            if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+                LOG.Warn() << "ResolutionScaler: Framebuffer is incomplete";
+            }
+        }
+
+        ResolutionScaler::~ResolutionScaler()
+        {
+            if(m_gl_forgotten) {
+                return;
+            }
+
+            glBindFramebuffer(GL_FRAMEBUFFER,0);
+            glDeleteFramebuffers(1,&m_fbo);
+            glDeleteRenderbuffers(1,&m_color_rb);
+            glDeleteRenderbuffers(1,&m_depth_stencil_rb);
+        }
+
+        GLuint ResolutionScaler::GetFramebuffer() const
+        {
+            return m_fbo;
+        }
+
+        uint ResolutionScaler::GetRenderWidth() const
+        {
+            return m_render_width;
+        }
+
+        uint ResolutionScaler::GetRenderHeight() const
+        {
+            return m_render_height;
+        }
+
+        float ResolutionScaler::GetScale() const
+        {
+            return m_scale.load(std::memory_order_relaxed);
+        }
+
+        void ResolutionScaler::Present(uint drawable_width,
+                                       uint drawable_height)
+        {
+            auto const now = std::chrono::high_resolution_clock::now();
+            if(m_have_timing) {
+                updateScale(now);
+            }
+            m_last_present = now;
+            m_have_timing = true;
+
+            glBindFramebuffer(GL_READ_FRAMEBUFFER,m_fbo);
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER,0);
+            glBlitFramebuffer(0,0,m_render_width,m_render_height,
+                              0,0,drawable_width,drawable_height,
+                              GL_COLOR_BUFFER_BIT,
+                              GL_LINEAR);
+
+            resize(drawable_width,drawable_height);
+
+            glBindFramebuffer(GL_FRAMEBUFFER,m_fbo);
+        }
+
+        void ResolutionScaler::FrameStarted()
+        {
+            m_frame_start = std::chrono::high_resolution_clock::now();
+        }
+
+        void ResolutionScaler::ForgetGLObjects()
+        {
+            m_gl_forgotten = true;
+        }
+
+        void ResolutionScaler::updateScale(TimePoint const &now)
+        {
+            float const interval_us =
+                    std::chrono::duration_cast<Microseconds>(
+                        now-m_last_present).count();
+
+            float const work_us =
+                    std::chrono::duration_cast<Microseconds>(
+                        now-m_frame_start).count();
+
+            float const budget_us = m_settings.frame_budget.count();
+
+            if(m_avg_interval_us == 0.0f) {
+                m_avg_interval_us = interval_us;
+                m_avg_work_us = work_us;
+            }
+            else {
+                m_avg_interval_us += (interval_us-m_avg_interval_us)*k_timing_weight;
+                m_avg_work_us += (work_us-m_avg_work_us)*k_timing_weight;
+            }
+
+            float scale = m_scale.load(std::memory_order_relaxed);
+
+            if(m_avg_interval_us > budget_us*k_overrun_tolerance) {
+                m_headroom_frames = 0;
+                if(scale > m_settings.min_scale) {
+                    scale = std::max(scale-m_settings.step,m_settings.min_scale);
+
+                    // Start over so that one slow stretch
+                    // doesn't step the scale down every frame
+                    m_avg_interval_us = 0.0f;
+                }
+            }
+            else if(m_avg_work_us < budget_us*m_settings.upscale_headroom) {
+                m_headroom_frames++;
+                if(m_headroom_frames >= m_settings.upscale_frames) {
+                    m_headroom_frames = 0;
+                    scale = std::min(scale+m_settings.step,m_settings.max_scale);
+                }
+            }
+            else {
+                m_headroom_frames = 0;
+            }
+
+            m_scale.store(scale,std::memory_order_relaxed);
+        }
+
+        void ResolutionScaler::resize(uint drawable_width,
+                                      uint drawable_height)
+        {
+            float const scale = m_scale.load(std::memory_order_relaxed);
+
+            uint const render_width = std::max(
+                        1u,uint(std::lround(drawable_width*scale)));
+
+            uint const render_height = std::max(
+                        1u,uint(std::lround(drawable_height*scale)));
+
+            if(render_width == m_render_width &&
+               render_height == m_render_height) {
+                return;
+            }
+
+            m_render_width = render_width;
+            m_render_height = render_height;
+
+            glBindRenderbuffer(GL_RENDERBUFFER,m_color_rb);
+            glRenderbufferStorage(GL_RENDERBUFFER,GL_RGBA8,
+                                  m_render_width,m_render_height);
+
+            glBindRenderbuffer(GL_RENDERBUFFER,m_depth_stencil_rb);
+            glRenderbufferStorage(GL_RENDERBUFFER,GL_DEPTH24_STENCIL8,
+                                  m_render_width,m_render_height);
+
+            glBindRenderbuffer(GL_RENDERBUFFER,0);
+        }
+    }
+}
@@ -0,0 +1,122 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef KS_PLATFORM_RESOLUTION_SCALER_HPP
+#define KS_PLATFORM_RESOLUTION_SCALER_HPP
+
+#include <atomic>
+
+#include <ks/gl/KsGLConfig.hpp>
+#include <ks/KsGlobal.hpp>
+
+namespace ks
+{
+    namespace gui
+    {
+        // ResolutionScaler
+        // * Owns a framebuffer that's rendered into at a scaled
+        //   down resolution and upscaled to the default
+        //   framebuffer when the frame is presented
+        // * The scale is lowered one step whenever the smoothed
+        //   frame interval goes over budget, and raised one step
+        //   once the frame has been comfortably within budget
+        //   for Settings::upscale_frames in a row
+        // * Frame time is measured on the cpu as the interval
+        //   between presents (which catches gpu bound frames
+        //   through the swap blocking) and the time spent
+        //   between presents outside of the swap (used to
+        //   judge headroom, since vsync hides it in the interval)
+        // * The blit requires GL 3.0 or GLES 3.0
+        // * All functions except GetScale must be called from
+        //   the thread the window's context is current on
+        class ResolutionScaler final
+        {
+        public:
+            struct Settings
+            {
+                float min_scale{0.5f};
+                float max_scale{1.0f};
+
+                // Scale changes by this much at a time; keeping
+                // it coarse limits framebuffer reallocations
+                float step{0.1f};
+
+                Microseconds frame_budget{16667};
+
+                // Work time must be under this fraction of the
+                // budget for upscale_frames frames before the
+                // scale is raised
+                float upscale_headroom{0.7f};
+                uint upscale_frames{60};
+            };
+
+            ResolutionScaler(Settings const &settings,
+                             uint drawable_width,
+                             uint drawable_height);
+
+            ~ResolutionScaler();
+
+            // Framebuffer to render into instead of the default
+            // framebuffer, and the size to set the viewport to
+            GLuint GetFramebuffer() const;
+            uint GetRenderWidth() const;
+            uint GetRenderHeight() const;
+
+            // Any thread
+            float GetScale() const;
+
+            // * Upscales the frame into the default framebuffer,
+            //   updates the scale and leaves the draw framebuffer
+            //   bound to the framebuffer for the next frame
+            // * Called before swapping
+            void Present(uint drawable_width, uint drawable_height);
+
+            // Called after the swap returns
+            void FrameStarted();
+
+            // * Drops the GL objects without deleting them, for
+            //   when their context can't be made current
+            // * The objects are leaked and the destructor makes
+            //   no GL calls
+            void ForgetGLObjects();
+
+        private:
+            void updateScale(TimePoint const &now);
+            void resize(uint drawable_width, uint drawable_height);
+
+            Settings const m_settings;
+
+            GLuint m_fbo;
+            GLuint m_color_rb;
+            GLuint m_depth_stencil_rb;
+            bool m_gl_forgotten;
+
+            uint m_render_width;
+            uint m_render_height;
+
+            std::atomic<float> m_scale;
+
+            TimePoint m_last_present;
+            TimePoint m_frame_start;
+            bool m_have_timing;
+            float m_avg_interval_us;
+            float m_avg_work_us;
+            uint m_headroom_frames;
+        };
+    }
+}
+
+#endif // KS_PLATFORM_RESOLUTION_SCALER_HPP
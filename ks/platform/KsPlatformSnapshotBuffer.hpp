@@ -0,0 +1,123 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef KS_PLATFORM_SNAPSHOT_BUFFER_HPP
+#define KS_PLATFORM_SNAPSHOT_BUFFER_HPP
+
+#include <atomic>
+#include <array>
+#include <type_traits>
+
+#include <ks/KsGlobal.hpp>
+
+namespace ks
+{
+    // SnapshotBuffer
+    // * Publishes copies of a value from a single writer
+    //   thread to any number of reader threads
+    // * Neither side takes a lock. The writer never waits.
+    //   Reads are lock-free but not wait-free: a reader
+    //   retries if the writer published N-1 more snapshots
+    //   while the reader was copying one out, and keeps
+    //   retrying for as long as the writer keeps lapping it.
+    //   A reader can only be lapped by a writer that publishes
+    //   N-1 times during a single copy, so in practice a read
+    //   takes one or two attempts
+    // * T must be trivially copyable since readers copy
+    //   the value while the writer may be filling another
+    //   slot
+    template<typename T, uint N=4>
+    class SnapshotBuffer final
+    {
+        static_assert(N >= 2,"SnapshotBuffer: N must be at least 2");
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "SnapshotBuffer: T must be trivially copyable");
+
+    public:
+        SnapshotBuffer() :
+            m_write_gen(0),
+            m_latest_gen(0)
+        {
+            for(auto& slot : m_list_slots) {
+                slot.seq.store(0,std::memory_order_relaxed);
+            }
+        }
+
+        SnapshotBuffer(SnapshotBuffer const &) = delete;
+        SnapshotBuffer& operator=(SnapshotBuffer const &) = delete;
+
+        // Writer thread only
+        void Publish(T const &value)
+        {
+            u64 const gen = m_write_gen+1;
+            Slot& slot = m_list_slots[gen%N];
+
+            // An odd sequence marks the slot as being written
+            u64 const seq = slot.seq.load(std::memory_order_relaxed);
+            slot.seq.store(seq+1,std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+
+            slot.value = value;
+
+            slot.seq.store(seq+2,std::memory_order_release);
+            m_latest_gen.store(gen,std::memory_order_release);
+            m_write_gen = gen;
+        }
+
+        // Any thread
+        T Read() const
+        {
+            for(;;) {
+                u64 const gen = m_latest_gen.load(std::memory_order_acquire);
+                Slot const &slot = m_list_slots[gen%N];
+
+                // The slot is being rewritten, which means the
+                // writer has lapped this reader since gen was read
+                u64 const seq_before = slot.seq.load(std::memory_order_acquire);
+                if(seq_before & 1) {
+                    continue;
+                }
+
+                T value = slot.value;
+
+                std::atomic_thread_fence(std::memory_order_acquire);
+                u64 const seq_after = slot.seq.load(std::memory_order_relaxed);
+                if(seq_before == seq_after) {
+                    return value;
+                }
+            }
+        }
+
+        // Any thread; increments once per Publish
+        u64 GetGeneration() const
+        {
+            return m_latest_gen.load(std::memory_order_acquire);
+        }
+
+    private:
+        struct Slot
+        {
+            std::atomic<u64> seq;
+            T value{};
+        };
+
+        u64 m_write_gen;
+        std::atomic<u64> m_latest_gen;
+        std::array<Slot,N> m_list_slots;
+    };
+}
+
+#endif // KS_PLATFORM_SNAPSHOT_BUFFER_HPP
@@ -0,0 +1,110 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef KS_PLATFORM_STATIC_DISPATCH_HPP
+#define KS_PLATFORM_STATIC_DISPATCH_HPP
+
+#include <ks/platform/KsPlatformOpts.hpp>
+
+#ifdef KS_ENV_SDL2
+#include <ks/platform/sdl/KsGuiPlatformSDL.hpp>
+#endif
+
+namespace ks
+{
+    namespace gui
+    {
+#ifdef KS_ENV_SDL2
+        // The concrete platform types for this build
+        using PlatformImpl = PlatformSDL;
+        using PlatformWindowImpl = PlatformWindowSDL;
+#endif
+
+        // StaticPlatform / StaticPlatformWindow
+        // * Front ends for the calls made every frame that bind
+        //   to the concrete platform types at compile time, so
+        //   the calls can be inlined instead of going through
+        //   IPlatform/IPlatformWindow
+        // * The calls are qualified with the concrete type, which
+        //   skips the vtable even without KS_PLATFORM_STATIC_DISPATCH;
+        //   defining it also lets the compiler devirtualize any other
+        //   call made through a PlatformImpl or PlatformWindowImpl
+        // * Only valid for objects created by this build's platform,
+        //   ie. the IPlatform passed to the app and the windows it
+        //   creates; the dynamic interface remains available for
+        //   everything else
+        template<typename PlatformT>
+        class StaticPlatform final
+        {
+        public:
+            explicit StaticPlatform(IPlatform& platform) :
+                m_platform(static_cast<PlatformT&>(platform))
+            {}
+
+            void ProcessEvents()
+            {
+                m_platform.PlatformT::ProcessEvents();
+            }
+
+            PlatformT& Get()
+            {
+                return m_platform;
+            }
+
+        private:
+            PlatformT& m_platform;
+        };
+
+        template<typename PlatformWindowT>
+        class StaticPlatformWindow final
+        {
+        public:
+            explicit StaticPlatformWindow(IPlatformWindow& window) :
+                m_window(static_cast<PlatformWindowT&>(window))
+            {}
+
+            bool IsCurrentContext()
+            {
+                return m_window.PlatformWindowT::IsCurrentContext();
+            }
+
+            void MakeContextCurrent()
+            {
+                m_window.PlatformWindowT::MakeContextCurrent();
+            }
+
+            void SwapBuffers()
+            {
+                m_window.PlatformWindowT::SwapBuffers();
+            }
+
+            PlatformWindowT& Get()
+            {
+                return m_window;
+            }
+
+        private:
+            PlatformWindowT& m_window;
+        };
+
+#ifdef KS_ENV_SDL2
+        using StaticPlatformImpl = StaticPlatform<PlatformImpl>;
+        using StaticPlatformWindowImpl = StaticPlatformWindow<PlatformWindowImpl>;
+#endif
+    }
+}
+
+#endif // KS_PLATFORM_STATIC_DISPATCH_HPP
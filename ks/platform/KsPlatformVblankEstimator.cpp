@@ -0,0 +1,195 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <algorithm>
+#include <cmath>
+
+#include <ks/platform/KsPlatformVblankEstimator.hpp>
+
+namespace ks
+{
+    namespace gui
+    {
+        namespace
+        {
+            // Weight of the newest sample in the jitter average
+            float const k_jitter_weight = 0.1f;
+
+            double getNs(Nanoseconds const &duration)
+            {
+                return double(duration.count());
+            }
+
+            Nanoseconds getDuration(double ns)
+            {
+                return Nanoseconds(static_cast<s64>(std::llround(ns)));
+            }
+        }
+
+        VblankEstimator::VblankEstimator(Settings const &settings) :
+            m_settings(settings)
+        {
+            Reset();
+        }
+
+        void VblankEstimator::AddSample(TimePoint const &timestamp)
+        {
+            if(!m_have_phase) {
+                resync(timestamp);
+                m_estimate_buffer.Publish(m_estimate);
+                return;
+            }
+
+            double const min_period = getNs(m_settings.min_period);
+            double const max_period = getNs(m_settings.max_period);
+
+            if(m_bootstrap_count < k_bootstrap_intervals) {
+                double const interval = getNs(timestamp-m_last_sample);
+                m_last_sample = timestamp;
+                m_phase = timestamp;
+
+                if(interval < min_period || interval > max_period) {
+                    // Either vsync isn't on or the app stalled
+                    m_estimate.outliers++;
+                }
+                else {
+                    m_list_bootstrap_intervals[m_bootstrap_count] = interval;
+                    m_bootstrap_count++;
+                    m_estimate.samples++;
+
+                    if(m_bootstrap_count == k_bootstrap_intervals) {
+                        auto const begin = m_list_bootstrap_intervals.begin();
+                        auto const median = begin+(k_bootstrap_intervals/2);
+                        std::nth_element(begin,median,m_list_bootstrap_intervals.end());
+                        m_period_ns = *median;
+                        m_accepted = k_bootstrap_intervals;
+                    }
+                }
+
+                m_estimate.period = getDuration(m_period_ns);
+                m_estimate.phase = m_phase;
+                m_estimate_buffer.Publish(m_estimate);
+                return;
+            }
+
+            m_last_sample = timestamp;
+
+            // Match the sample to the nearest predicted vblank
+            double const elapsed = getNs(timestamp-m_phase);
+            double const refreshes = std::round(elapsed/m_period_ns);
+            double const error = elapsed-(refreshes*m_period_ns);
+
+            bool const outlier =
+                    (refreshes < 1.0) ||
+                    (std::fabs(error) > m_settings.outlier_threshold*m_period_ns);
+
+            if(outlier) {
+                m_estimate.outliers++;
+                m_consecutive_outliers++;
+
+                if(m_consecutive_outliers >= m_settings.resync_outliers) {
+                    m_estimate.resyncs++;
+                    resync(timestamp);
+                }
+            }
+            else {
+                m_consecutive_outliers = 0;
+                m_accepted++;
+                m_estimate.samples++;
+
+                m_phase += getDuration((refreshes*m_period_ns)+
+                                       (m_settings.phase_gain*error));
+
+                m_period_ns += (m_settings.period_gain*error)/refreshes;
+                m_period_ns = std::max(min_period,std::min(max_period,m_period_ns));
+
+                m_estimate.jitter +=
+                        k_jitter_weight*
+                        ((std::fabs(error)/m_period_ns)-m_estimate.jitter);
+            }
+
+            // Confidence grows with the accepted samples, falls
+            // with jitter and fades over a run of outliers
+            float const warmup =
+                    std::min(1.0f,float(m_accepted)/
+                             float(std::max(1u,m_settings.warmup_samples)));
+
+            float const consistency =
+                    1.0f-std::min(1.0f,m_estimate.jitter/m_settings.outlier_threshold);
+
+            float const lock =
+                    1.0f-(float(m_consecutive_outliers)/
+                          float(std::max(1u,m_settings.resync_outliers)));
+
+            m_estimate.confidence = warmup*consistency*lock;
+            m_estimate.period = getDuration(m_period_ns);
+            m_estimate.phase = m_phase;
+            m_estimate_buffer.Publish(m_estimate);
+        }
+
+        void VblankEstimator::Reset()
+        {
+            m_have_phase = false;
+            m_period_ns = getNs(m_settings.nominal_period);
+            m_accepted = 0;
+            m_bootstrap_count = 0;
+            m_consecutive_outliers = 0;
+
+            m_estimate = Estimate();
+            m_estimate_buffer.Publish(m_estimate);
+        }
+
+        VblankEstimator::Estimate VblankEstimator::GetEstimate() const
+        {
+            return m_estimate_buffer.Read();
+        }
+
+        TimePoint VblankEstimator::GetNextVblank(TimePoint const &time) const
+        {
+            return GetNextVblank(GetEstimate(),time);
+        }
+
+        TimePoint VblankEstimator::GetNextVblank(Estimate const &estimate,
+                                                 TimePoint const &time)
+        {
+            if(estimate.period.count() <= 0 || estimate.samples == 0) {
+                return time;
+            }
+
+            double const period = getNs(estimate.period);
+            double const elapsed = getNs(time-estimate.phase);
+            double const refreshes = std::floor(elapsed/period)+1.0;
+
+            return estimate.phase+getDuration(refreshes*period);
+        }
+
+        void VblankEstimator::resync(TimePoint const &timestamp)
+        {
+            m_have_phase = true;
+            m_period_ns = getNs(m_settings.nominal_period);
+            m_phase = timestamp;
+            m_last_sample = timestamp;
+            m_accepted = 0;
+            m_bootstrap_count = 0;
+            m_consecutive_outliers = 0;
+
+            m_estimate.period = getDuration(m_period_ns);
+            m_estimate.phase = m_phase;
+            m_estimate.confidence = 0.0f;
+            m_estimate.jitter = 0.0f;
+        }
+    }
+}
@@ -0,0 +1,137 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef KS_PLATFORM_VBLANK_ESTIMATOR_HPP
+#define KS_PLATFORM_VBLANK_ESTIMATOR_HPP
+
+#include <array>
+
+#include <ks/KsGlobal.hpp>
+#include <ks/platform/KsPlatformSnapshotBuffer.hpp>
+
+namespace ks
+{
+    namespace gui
+    {
+        // VblankEstimator
+        // * Learns a display's refresh period and vblank phase from
+        //   the times at which swaps return, which with vsync on
+        //   are locked to the refresh plus a roughly constant delay
+        // * Works like a phase locked loop: each sample is matched
+        //   to the nearest predicted vblank, and the error nudges
+        //   the phase and (spread over the refreshes since the last
+        //   sample) the period, so slow drift between the display
+        //   and cpu clocks is tracked
+        // * Samples whose error is over Settings::outlier_threshold
+        //   of a period (ie. a swap that was descheduled) are
+        //   ignored; after Settings::resync_outliers in a row the
+        //   estimate is assumed lost and rebuilt from the new
+        //   samples
+        // * Timestamps are passed in, so the estimator doesn't
+        //   depend on a display and can be fed simulated timings
+        // * AddSample must be called from a single thread; the
+        //   Get functions are safe from any thread
+        class VblankEstimator final
+        {
+        public:
+            struct Settings
+            {
+                // Starting period; usually the display mode's
+                // refresh rate
+                Microseconds nominal_period{16667};
+
+                // The period is kept within these bounds
+                Microseconds min_period{2500};
+                Microseconds max_period{100000};
+
+                float phase_gain{0.1f};
+                float period_gain{0.01f};
+
+                // Fraction of a period
+                float outlier_threshold{0.25f};
+                uint resync_outliers{8};
+
+                // Accepted samples before confidence can reach 1
+                uint warmup_samples{30};
+            };
+
+            struct Estimate
+            {
+                Nanoseconds period{0};
+
+                // A time at which a vblank (as seen by swaps
+                // returning) occurred or is predicted to occur
+                TimePoint phase;
+
+                // 0 when nothing is known, approaching 1 as the
+                // samples are consistently close to the predictions
+                float confidence{0.0f};
+
+                // Mean absolute error of accepted samples as a
+                // fraction of the period
+                float jitter{0.0f};
+
+                u64 samples{0};
+                u64 outliers{0};
+                u64 resyncs{0};
+            };
+
+            VblankEstimator(Settings const &settings);
+
+            void AddSample(TimePoint const &timestamp);
+            void Reset();
+
+            // Any thread
+            Estimate GetEstimate() const;
+
+            // * Any thread
+            // * Returns the first predicted vblank after time, or
+            //   time itself if there is no estimate yet
+            TimePoint GetNextVblank(TimePoint const &time) const;
+
+            static TimePoint GetNextVblank(Estimate const &estimate,
+                                           TimePoint const &time);
+
+        private:
+            // * After a resync the period is taken from the median
+            //   of this many intervals before the phase locked loop
+            //   takes over
+            // * Swaps that miss a refresh give multiples of the
+            //   period and a late swap gives a short interval and a
+            //   long one, so the median is a robust first guess as
+            //   long as most swaps make the next refresh
+            static uint const k_bootstrap_intervals = 8;
+
+            void resync(TimePoint const &timestamp);
+
+            Settings const m_settings;
+
+            bool m_have_phase;
+            double m_period_ns;
+            TimePoint m_phase;
+            TimePoint m_last_sample;
+            uint m_accepted;
+            uint m_bootstrap_count;
+            std::array<double,k_bootstrap_intervals> m_list_bootstrap_intervals;
+            uint m_consecutive_outliers;
+
+            Estimate m_estimate;
+            SnapshotBuffer<Estimate> m_estimate_buffer;
+        };
+    }
+}
+
+#endif // KS_PLATFORM_VBLANK_ESTIMATOR_HPP
@@ -155,6 +155,33 @@ namespace ks
                 {SDLK_MENU, KeyEvent::Key::KEY_MENU}
             };
 
+            uint ConvertSDLKeyMods(Uint16 sdl_mods)
+            {
+                uint mods = KeyEvent::MOD_NONE;
+
+                if(sdl_mods & KMOD_CTRL)
+                {
+                    mods |= KeyEvent::MOD_CTRL;
+                }
+
+                if(sdl_mods & KMOD_SHIFT)
+                {
+                    mods |= KeyEvent::MOD_SHIFT;
+                }
+
+                if(sdl_mods & KMOD_ALT)
+                {
+                    mods |= KeyEvent::MOD_ALT;
+                }
+
+                if(sdl_mods & KMOD_GUI)
+                {
+                    mods |= KeyEvent::MOD_SUPER;
+                }
+
+                return mods;
+            }
+
             KeyEvent ConvertSDLKeyEvent(
                     SDL_KeyboardEvent const &sdl_event)
             {
@@ -176,27 +203,7 @@ namespace ks
                         static_cast<uint>(sdl_event.keysym.scancode);
 
                 // Modifiers
-                ks_event.mods = KeyEvent::MOD_NONE;
-
-                if(sdl_event.keysym.mod & KMOD_CTRL)
-                {
-                    ks_event.mods |= KeyEvent::MOD_CTRL;
-                }
-
-                if(sdl_event.keysym.mod & KMOD_SHIFT)
-                {
-                    ks_event.mods |= KeyEvent::MOD_SHIFT;
-                }
-
-                if(sdl_event.keysym.mod & KMOD_ALT)
-                {
-                    ks_event.mods |= KeyEvent::MOD_ALT;
-                }
-
-                if(sdl_event.keysym.mod & KMOD_GUI)
-                {
-                    ks_event.mods |= KeyEvent::MOD_SUPER;
-                }
+                ks_event.mods = ConvertSDLKeyMods(sdl_event.keysym.mod);
 
                 // Key
                 auto key_it = keymap_sdl_ks.find(sdl_event.keysym.sym);
@@ -213,10 +220,26 @@ namespace ks
             }
         }
 
+        // Converts an SDL event timestamp to a TimePoint given
+        // a pair of reference times taken together. Events may
+        // be stamped after the reference times were taken so
+        // the difference is signed
+        inline TimePoint ConvertSDLTimestamp(
+                Uint32 sdl_timestamp,
+                Uint32 sdl_ev_proc_time,
+                TimePoint const &ks_ev_proc_time)
+        {
+            sint const diff_ms =
+                    static_cast<sint>(sdl_ev_proc_time-sdl_timestamp);
+
+            return ks_ev_proc_time-Milliseconds(diff_ms);
+        }
+
         TouchEvent ConvertSDLTouchFingerEvent(
                 SDL_TouchFingerEvent const &sdl_event,
                 Uint32 sdl_ev_proc_time,
                 TimePoint const &ks_ev_proc_time,
+                uint index,
                 float active_win_width,
                 float active_win_height)
         {
@@ -240,7 +263,9 @@ namespace ks
                 ks_event.action = TouchEvent::Action::Release;
             }
 
-            ks_event.index = sdl_event.fingerId;
+            // SDL finger ids are 64-bit and may not be small
+            // or sequential so the caller provides the index
+            ks_event.index = index;
             ks_event.x = sdl_event.x*active_win_width;
             ks_event.y = sdl_event.y*active_win_height;
 
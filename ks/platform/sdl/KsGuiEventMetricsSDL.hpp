@@ -0,0 +1,159 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef KS_GUI_EVENT_METRICS_SDL_HPP
+#define KS_GUI_EVENT_METRICS_SDL_HPP
+
+#include <array>
+
+#include <SDL2/SDL.h>
+
+#include <ks/KsGlobal.hpp>
+
+namespace ks
+{
+    namespace gui
+    {
+        // EventQueueMetrics
+        // * Health of SDL's event queue as seen by ProcessEvents
+        // * Per pump values describe the most recent ProcessEvents
+        //   call; totals accumulate until ResetEventQueueMetrics
+        struct EventQueueMetrics
+        {
+            enum Category : uint
+            {
+                CategoryQuit,
+                CategoryApp,
+                CategoryWindow,
+                CategoryKey,
+                CategoryText,
+                CategoryMouseButton,
+                CategoryMouseMotion,
+                CategoryMouseWheel,
+                CategoryTouch,
+                CategoryController,
+                CategoryOther,
+                CategoryCount
+            };
+
+            static Category GetCategory(Uint32 sdl_event_type)
+            {
+                switch(sdl_event_type)
+                {
+                    case SDL_QUIT:
+                        return CategoryQuit;
+                    case SDL_APP_TERMINATING:
+                    case SDL_APP_LOWMEMORY:
+                    case SDL_APP_WILLENTERBACKGROUND:
+                    case SDL_APP_DIDENTERBACKGROUND:
+                    case SDL_APP_WILLENTERFOREGROUND:
+                    case SDL_APP_DIDENTERFOREGROUND:
+                        return CategoryApp;
+                    case SDL_WINDOWEVENT:
+                        return CategoryWindow;
+                    case SDL_KEYDOWN:
+                    case SDL_KEYUP:
+                        return CategoryKey;
+                    case SDL_TEXTINPUT:
+                    case SDL_TEXTEDITING:
+                        return CategoryText;
+                    case SDL_MOUSEBUTTONDOWN:
+                    case SDL_MOUSEBUTTONUP:
+                        return CategoryMouseButton;
+                    case SDL_MOUSEMOTION:
+                        return CategoryMouseMotion;
+                    case SDL_MOUSEWHEEL:
+                        return CategoryMouseWheel;
+                    case SDL_FINGERDOWN:
+                    case SDL_FINGERUP:
+                    case SDL_FINGERMOTION:
+                        return CategoryTouch;
+                    case SDL_CONTROLLERAXISMOTION:
+                    case SDL_CONTROLLERBUTTONDOWN:
+                    case SDL_CONTROLLERBUTTONUP:
+                    case SDL_CONTROLLERDEVICEADDED:
+                    case SDL_CONTROLLERDEVICEREMOVED:
+                    case SDL_CONTROLLERDEVICEREMAPPED:
+                        return CategoryController;
+                    default:
+                        return CategoryOther;
+                }
+            }
+
+            // Thresholds for PlatformSDL::signal_event_queue_backlog;
+            // zero disables a threshold
+            struct Thresholds
+            {
+                uint queue_depth{0};
+                Milliseconds latency{0};
+            };
+
+            u64 pump{0};
+
+            // Per pump
+            std::array<uint,CategoryCount> counts{};
+
+            // Events waiting in the queue when the pump started
+            uint queue_depth{0};
+
+            // Events deferred to the next pump by a dispatch budget
+            uint deferred{0};
+
+            // Deferred mouse motion merged into the deferred motion
+            // before it; the motion isn't lost, so these aren't
+            // counted as dropped
+            uint merged{0};
+
+            // Time from an event's SDL timestamp to when it was
+            // processed; SDL timestamps have 1ms resolution
+            Milliseconds latency_max{0};
+            float latency_mean_ms{0.0f};
+
+            // Totals
+            u64 total_events{0};
+            uint queue_high_water{0};
+
+            // Window events for windows that don't exist (ie.
+            // latent events for a destroyed window)
+            u64 ignored_unknown_window{0};
+
+            // Event types or window events that aren't handled
+            u64 ignored_unhandled{0};
+
+            // * Events that were queued but never processed, which
+            //   happens to events left after SDL_QUIT
+            // * SDL drops events silently once its queue is full
+            //   (SDL_MAX_QUEUED_EVENTS); a pump that finds the
+            //   queue at that size is counted in queue_overflows
+            //   since events were likely lost
+            u64 dropped{0};
+            u64 queue_overflows{0};
+            u64 total_merged{0};
+
+            // * Events injected through PlatformSDL::Inject*, which
+            //   bypass SDL's queue and aren't included in the
+            //   values above
+            // * injected is per pump; injected_dropped counts
+            //   events rejected because the injection queue was
+            //   full or discarded after SDL_QUIT
+            uint injected{0};
+            u64 total_injected{0};
+            u64 injected_dropped{0};
+        };
+    }
+}
+
+#endif // KS_GUI_EVENT_METRICS_SDL_HPP
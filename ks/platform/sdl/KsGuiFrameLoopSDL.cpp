@@ -0,0 +1,182 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <ks/platform/sdl/KsGuiFrameLoopSDL.hpp>
+
+#include <ks/KsLog.hpp>
+#include <ks/platform/sdl/KsGuiPlatformSDL.hpp>
+
+namespace ks
+{
+    namespace gui
+    {
+        namespace
+        {
+            Microseconds getElapsed(TimePoint const &start, TimePoint const &end)
+            {
+                return std::chrono::duration_cast<Microseconds>(end-start);
+            }
+        }
+
+        FrameLoopSDL::FrameLoopSDL(shared_ptr<PlatformSDL> platform,
+                                   Settings const &settings) :
+            m_platform(platform),
+            m_stop(false)
+        {
+            SetSettings(settings);
+        }
+
+        FrameLoopSDL::~FrameLoopSDL()
+        {
+
+        }
+
+        void FrameLoopSDL::Run()
+        {
+            LOG.Trace() << "FrameLoopSDL::Run";
+
+            m_stop = false;
+            m_timing = Timing();
+
+            Id const cid_quit =
+                    m_platform->signal_quit.Connect(
+                        [this](){ m_stop = true; });
+
+            // The accumulator is kept in microseconds so the
+            // leftover time doesn't drift over a long run
+            Microseconds accumulator(0);
+            TimePoint prev_frame_start = std::chrono::high_resolution_clock::now();
+
+            while(!m_stop) {
+                Settings const settings = m_settings;
+                Microseconds const update_interval = settings.update_interval;
+
+                TimePoint const frame_start = std::chrono::high_resolution_clock::now();
+                m_timing.interval = getElapsed(prev_frame_start,frame_start);
+                prev_frame_start = frame_start;
+
+                m_timing.pump = Microseconds(0);
+                m_timing.update = Microseconds(0);
+                m_timing.render = Microseconds(0);
+                m_timing.updates = 0;
+
+                accumulator += m_timing.interval;
+
+                if(settings.pump_point == PumpPoint::BeforeUpdates) {
+                    pump(m_timing.pump);
+                }
+
+                // Updates
+                TimePoint const update_start = std::chrono::high_resolution_clock::now();
+                Microseconds update_pump_time(0);
+
+                while(!m_stop && accumulator >= update_interval) {
+                    if(m_timing.updates == settings.max_updates_per_frame) {
+                        // Drop the whole intervals that are left
+                        // and keep the remainder for alpha
+                        u64 const skipped = accumulator.count()/update_interval.count();
+                        m_timing.skipped_updates += skipped;
+                        accumulator -= update_interval*skipped;
+                        break;
+                    }
+
+                    if(settings.pump_point == PumpPoint::EachUpdate) {
+                        pump(update_pump_time);
+                        if(m_stop) {
+                            break;
+                        }
+                    }
+
+                    signal_update.Emit(update_interval);
+                    accumulator -= update_interval;
+                    m_timing.updates++;
+                }
+
+                m_timing.update =
+                        getElapsed(update_start,std::chrono::high_resolution_clock::now())-
+                        update_pump_time;
+                m_timing.pump += update_pump_time;
+                m_timing.total_updates += m_timing.updates;
+
+                if((settings.pump_point == PumpPoint::BeforeRender) ||
+                   (settings.pump_point == PumpPoint::EachUpdate && m_timing.updates == 0)) {
+                    pump(m_timing.pump);
+                }
+
+                if(m_stop) {
+                    break;
+                }
+
+                // Render
+                m_timing.alpha =
+                        float(accumulator.count())/
+                        float(update_interval.count());
+
+                TimePoint const render_start = std::chrono::high_resolution_clock::now();
+                signal_render.Emit(m_timing.alpha);
+                m_timing.render =
+                        getElapsed(render_start,std::chrono::high_resolution_clock::now());
+
+                m_timing.frame++;
+                m_timing_buffer.Publish(m_timing);
+            }
+
+            m_platform->signal_quit.Disconnect(cid_quit);
+
+            LOG.Trace() << "FrameLoopSDL::Run returned";
+        }
+
+        void FrameLoopSDL::Stop()
+        {
+            m_stop = true;
+        }
+
+        void FrameLoopSDL::SetSettings(Settings const &settings)
+        {
+            m_settings = settings;
+
+            if(m_settings.update_interval.count() <= 0) {
+                LOG.Warn() << "FrameLoopSDL: Invalid update interval, "
+                              "using 1us";
+                m_settings.update_interval = Microseconds(1);
+            }
+
+            if(m_settings.max_updates_per_frame == 0) {
+                m_settings.max_updates_per_frame = 1;
+            }
+        }
+
+        FrameLoopSDL::Settings const & FrameLoopSDL::GetSettings() const
+        {
+            return m_settings;
+        }
+
+        FrameLoopSDL::Timing FrameLoopSDL::GetTiming() const
+        {
+            return m_timing_buffer.Read();
+        }
+
+        void FrameLoopSDL::pump(Microseconds& pump_time)
+        {
+            TimePoint const start = std::chrono::high_resolution_clock::now();
+
+            m_platform->ProcessEvents();
+            m_platform->GetEventLoop()->ProcessEvents();
+
+            pump_time += getElapsed(start,std::chrono::high_resolution_clock::now());
+        }
+    }
+}
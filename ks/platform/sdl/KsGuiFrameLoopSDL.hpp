@@ -0,0 +1,137 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef KS_GUI_FRAME_LOOP_SDL_HPP
+#define KS_GUI_FRAME_LOOP_SDL_HPP
+
+#include <atomic>
+
+#include <ks/KsGlobal.hpp>
+#include <ks/platform/KsPlatformSnapshotBuffer.hpp>
+
+namespace ks
+{
+    namespace gui
+    {
+        class PlatformSDL;
+
+        // FrameLoopSDL
+        // * Drives an app with fixed rate simulation updates and
+        //   variable rate rendering, in place of PlatformSDL::Run
+        // * Each frame, the time since the previous frame is added
+        //   to an accumulator and signal_update is emitted once for
+        //   every whole update interval in it. signal_render is
+        //   then emitted with the fraction of an interval left
+        //   over (alpha), which can be used to interpolate between
+        //   the previous and current simulation states
+        // * At most Settings::max_updates_per_frame updates are run
+        //   per frame; whole intervals beyond that are discarded
+        //   and counted in Timing::skipped_updates, so a slow
+        //   frame slows the simulation down instead of making the
+        //   next frame slower (the 'spiral of death')
+        // * Platform events and the platform event loop's pending
+        //   tasks and timers are processed at the pump point
+        // * The render handler should draw and swap; with vsync on,
+        //   the swap is what paces the loop
+        class FrameLoopSDL final
+        {
+        public:
+            enum class PumpPoint
+            {
+                // Once per frame, before any updates; input is
+                // at most one frame old when updates see it
+                BeforeUpdates,
+
+                // Once per frame, after updates and before
+                // rendering; for apps that handle input at
+                // render time
+                BeforeRender,
+
+                // Before each update, so every update sees the
+                // newest input; if no update is due the pump
+                // happens before rendering
+                EachUpdate
+            };
+
+            struct Settings
+            {
+                Microseconds update_interval{16667};
+                uint max_updates_per_frame{5};
+                PumpPoint pump_point{PumpPoint::BeforeUpdates};
+            };
+
+            // * Per frame values describe the most recent frame
+            // * Totals accumulate from the start of Run
+            struct Timing
+            {
+                u64 frame{0};
+
+                // Per frame
+                Microseconds interval{0};
+                Microseconds pump{0};
+                Microseconds update{0};
+                Microseconds render{0};
+                uint updates{0};
+                float alpha{0.0f};
+
+                // Totals
+                u64 total_updates{0};
+                u64 skipped_updates{0};
+            };
+
+            FrameLoopSDL(shared_ptr<PlatformSDL> platform,
+                         Settings const &settings);
+
+            ~FrameLoopSDL();
+
+            // * Runs frames until Stop is called or the platform
+            //   emits signal_quit
+            // * Must be called from the platform's event loop
+            //   thread, which shouldn't be running otherwise
+            void Run();
+
+            // Any thread
+            void Stop();
+
+            // * Takes effect at the start of the next frame
+            // * Must be called from the thread that calls Run
+            void SetSettings(Settings const &settings);
+            Settings const & GetSettings() const;
+
+            // Any thread
+            Timing GetTiming() const;
+
+            // Emitted with Settings::update_interval
+            Signal<Microseconds> signal_update;
+
+            // Emitted with alpha in [0,1)
+            Signal<float> signal_render;
+
+        private:
+            void pump(Microseconds& pump_time);
+
+            shared_ptr<PlatformSDL> m_platform;
+            Settings m_settings;
+
+            std::atomic<bool> m_stop;
+
+            Timing m_timing;
+            SnapshotBuffer<Timing> m_timing_buffer;
+        };
+    }
+}
+
+#endif // KS_GUI_FRAME_LOOP_SDL_HPP
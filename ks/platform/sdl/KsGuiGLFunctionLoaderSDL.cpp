@@ -0,0 +1,177 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <ks/platform/sdl/KsGuiGLFunctionLoaderSDL.hpp>
+
+namespace ks
+{
+    namespace gui
+    {
+        namespace
+        {
+            struct ContextTable
+            {
+                bool es{false};
+                int major{0};
+                int minor{0};
+                std::unordered_map<std::string,void*> procs;
+            };
+
+            std::mutex g_loader_mutex;
+            std::unordered_map<SDL_GLContext,ContextTable> g_list_tables;
+
+            // The context whose table last filled the global
+            // function pointers
+            SDL_GLContext g_loaded_context = nullptr;
+
+            // The table glad is loading from in Load
+            ContextTable* g_loading_table = nullptr;
+
+            void* resolve(ContextTable& table, char const * name)
+            {
+                auto it = table.procs.find(name);
+                if(it != table.procs.end()) {
+                    return it->second;
+                }
+
+                void* proc = SDL_GL_GetProcAddress(name);
+                table.procs.emplace(name,proc);
+                return proc;
+            }
+
+            void* gladResolve(char const * name)
+            {
+                return resolve(*g_loading_table,name);
+            }
+
+            ContextTable& getTable(SDL_GLContext context)
+            {
+                auto it = g_list_tables.find(context);
+                if(it != g_list_tables.end()) {
+                    return it->second;
+                }
+
+                ContextTable& table = g_list_tables[context];
+
+                // The API and version are read from the context
+                // itself since they can differ from what was
+                // requested when it was created
+                typedef GLubyte const * (APIENTRYP GetStringFn)(GLenum);
+                auto get_string =
+                        reinterpret_cast<GetStringFn>(
+                            resolve(table,"glGetString"));
+
+                char const * version = get_string ?
+                        reinterpret_cast<char const *>(get_string(GL_VERSION)) :
+                        nullptr;
+
+                if(version) {
+                    // ie. "OpenGL ES 3.0 ..." or "4.5.0 ..."
+                    char const * es_prefix = "OpenGL ES";
+                    table.es = (std::strncmp(version,es_prefix,std::strlen(es_prefix)) == 0);
+
+                    while(*version && (*version < '0' || *version > '9')) {
+                        version++;
+                    }
+                    table.major = std::atoi(version);
+
+                    char const * minor = std::strchr(version,'.');
+                    if(minor) {
+                        table.minor = std::atoi(minor+1);
+                    }
+                }
+
+                return table;
+            }
+        }
+
+        bool GLFunctionLoaderSDL::Load(SDL_GLContext context)
+        {
+            std::lock_guard<std::mutex> lock(g_loader_mutex);
+            if(context == g_loaded_context) {
+                return true;
+            }
+
+            ContextTable& table = getTable(context);
+
+            if(g_loaded_context) {
+                ContextTable const &loaded = g_list_tables[g_loaded_context];
+                if(loaded.es == table.es && loaded.major == table.major) {
+                    // Same kind of context; the loaded pointers
+                    // are valid for it
+                    g_loaded_context = context;
+                    return true;
+                }
+            }
+
+#ifdef KS_ENV_GL_LOAD_FUNCPTRS
+            g_loading_table = &table;
+            int const loaded = gladLoadGLLoader(gladResolve);
+            g_loading_table = nullptr;
+
+            if(!loaded) {
+                return false;
+            }
+#endif
+            g_loaded_context = context;
+            return true;
+        }
+
+        GLFunctionLoaderSDL::Version
+        GLFunctionLoaderSDL::GetVersion(SDL_GLContext context)
+        {
+            std::lock_guard<std::mutex> lock(g_loader_mutex);
+            ContextTable const &table = getTable(context);
+
+            Version version;
+            version.es = table.es;
+            version.major = table.major;
+            version.minor = table.minor;
+
+            return version;
+        }
+
+        void GLFunctionLoaderSDL::RemoveContext(SDL_GLContext context)
+        {
+            std::lock_guard<std::mutex> lock(g_loader_mutex);
+            g_list_tables.erase(context);
+
+            // The pointers stay loaded but there's no table
+            // to compare the next context against, so the next
+            // Load fills them again
+            if(g_loaded_context == context) {
+                g_loaded_context = nullptr;
+            }
+        }
+
+        void* GLFunctionLoaderSDL::GetProcAddress(char const * name)
+        {
+            SDL_GLContext context = SDL_GL_GetCurrentContext();
+            if(context == nullptr) {
+                return nullptr;
+            }
+
+            std::lock_guard<std::mutex> lock(g_loader_mutex);
+            return resolve(getTable(context),name);
+        }
+    }
+}
@@ -0,0 +1,77 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef KS_GUI_GL_FUNCTION_LOADER_SDL_HPP
+#define KS_GUI_GL_FUNCTION_LOADER_SDL_HPP
+
+#include <ks/gl/KsGLConfig.hpp>
+
+#include <SDL2/SDL.h>
+
+#include <ks/KsGlobal.hpp>
+
+namespace ks
+{
+    namespace gui
+    {
+        // GLFunctionLoaderSDL
+        // * Resolves GL entry points through SDL_GL_GetProcAddress
+        //   into a table kept per context, so that each pointer is
+        //   looked up at most once per context
+        // * The function pointers used by the rest of ks are global
+        //   (glad) and are filled eagerly: Load resolves glad's
+        //   whole table the first time a context is made current,
+        //   or when switching to a context of a different API (GL
+        //   or GLES) or major version than the one that last
+        //   filled them. Only GetProcAddress resolves lazily, for
+        //   entry points outside of glad's table
+        // * Contexts of the same API and major version are assumed
+        //   to share entry points; contexts of different kinds can
+        //   be mixed, but not used on different threads at once
+        class GLFunctionLoaderSDL final
+        {
+        public:
+            struct Version
+            {
+                bool es{false};
+                int major{0};
+                int minor{0};
+            };
+
+            // * Makes sure the global function pointers are valid
+            //   for context, which must be current on the calling
+            //   thread
+            // * Returns false if the pointers couldn't be loaded
+            static bool Load(SDL_GLContext context);
+
+            // * Returns the API and version context reports through
+            //   GL_VERSION, which can differ from what was requested
+            //   when it was created
+            // * context must be current on the calling thread
+            static Version GetVersion(SDL_GLContext context);
+
+            // Drops the table for a context that's being destroyed
+            static void RemoveContext(SDL_GLContext context);
+
+            // * Returns the entry point for the current context,
+            //   resolving and caching it on first use
+            // * Returns nullptr if it isn't available
+            static void* GetProcAddress(char const * name);
+        };
+    }
+}
+
+#endif // KS_GUI_GL_FUNCTION_LOADER_SDL_HPP
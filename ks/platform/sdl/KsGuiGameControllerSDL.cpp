@@ -0,0 +1,413 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <algorithm>
+#include <cmath>
+
+#include <ks/KsLog.hpp>
+#include <ks/platform/sdl/KsGuiGameControllerSDL.hpp>
+
+namespace ks
+{
+    namespace gui
+    {
+        namespace
+        {
+            SDL_EventType const g_list_joystick_events[] = {
+                SDL_JOYAXISMOTION,
+                SDL_JOYBALLMOTION,
+                SDL_JOYHATMOTION,
+#if SDL_VERSION_ATLEAST(2,0,10)
+                SDL_JOYBUTTONDOWN,
+#endif
+                SDL_JOYBUTTONUP
+            };
+
+            float NormalizeSDLAxis(Sint16 value)
+            {
+                // SDL axes are in [-32768,32767]
+                float const norm = value/32767.0f;
+                return (norm < -1.0f) ? -1.0f : norm;
+            }
+
+            float ApplyLinearDeadzone(float value, float deadzone)
+            {
+                if(value <= deadzone) {
+                    return 0.0f;
+                }
+                return std::min((value-deadzone)/(1.0f-deadzone),1.0f);
+            }
+        }
+
+        // ============================================================= //
+
+        GameControllerInputSDL::GameControllerInputSDL(
+                shared_ptr<EventLoop> event_loop) :
+            m_event_loop(event_loop),
+            m_hotplugged(false),
+            m_sample(0)
+        {
+            m_list_sdl_controllers.fill(nullptr);
+            m_list_instance_ids.fill(-1);
+            m_raw_axes.fill(0.0f);
+            m_filtered_axes.fill(0.0f);
+            m_buttons.fill(0);
+            m_latched_buttons.fill(0);
+
+            // SDL queues DEVICEADDED for each attached controller
+            // when it initializes the subsystem, but not when the
+            // subsystem was already initialized
+            bool const was_init = (SDL_WasInit(SDL_INIT_GAMECONTROLLER) != 0);
+
+            if(SDL_InitSubSystem(SDL_INIT_GAMECONTROLLER) < 0) {
+                std::string const err_msg(SDL_GetError());
+                throw PlatformInitFailed(
+                            "SDL: Failed to init game controllers: "+err_msg);
+            }
+
+            // We sample axes and buttons directly so there's no
+            // need to queue an event for every change. Button
+            // presses are still queued to latch short presses
+            m_prev_axis_motion_state =
+                    SDL_EventState(SDL_CONTROLLERAXISMOTION,SDL_IGNORE);
+            m_prev_button_up_state =
+                    SDL_EventState(SDL_CONTROLLERBUTTONUP,SDL_IGNORE);
+
+            // The raw joystick events behind them aren't needed
+            // either. Before 2.0.10 SDL generated controller events
+            // from the queued joystick events, so the button down
+            // event is kept there
+            static_assert(sizeof(g_list_joystick_events)/
+                          sizeof(g_list_joystick_events[0]) ==
+                          JoystickEventCount,
+                          "Joystick event list doesn't match count");
+
+            for(uint i=0; i < m_prev_joystick_states.size(); i++) {
+                m_prev_joystick_states[i] =
+                        SDL_EventState(g_list_joystick_events[i],SDL_IGNORE);
+            }
+
+            // Controllers that are already attached are opened when
+            // their DEVICEADDED events are processed, so that
+            // signal_controller_added can be connected first
+            if(was_init) {
+                int const joystick_count = SDL_NumJoysticks();
+                for(int i=0; i < joystick_count; i++) {
+                    if(SDL_IsGameController(i)) {
+                        SDL_Event sdl_event;
+                        SDL_zero(sdl_event);
+                        sdl_event.type = SDL_CONTROLLERDEVICEADDED;
+                        sdl_event.cdevice.which = i;
+                        SDL_PushEvent(&sdl_event);
+                    }
+                }
+            }
+
+            updateTimer();
+        }
+
+        GameControllerInputSDL::~GameControllerInputSDL()
+        {
+            m_timer.reset();
+
+            for(auto sdl_controller : m_list_sdl_controllers) {
+                if(sdl_controller) {
+                    SDL_GameControllerClose(sdl_controller);
+                }
+            }
+
+            SDL_EventState(SDL_CONTROLLERAXISMOTION,m_prev_axis_motion_state);
+            SDL_EventState(SDL_CONTROLLERBUTTONUP,m_prev_button_up_state);
+            for(uint i=0; i < m_prev_joystick_states.size(); i++) {
+                SDL_EventState(g_list_joystick_events[i],
+                               m_prev_joystick_states[i]);
+            }
+
+            SDL_QuitSubSystem(SDL_INIT_GAMECONTROLLER);
+        }
+
+        void GameControllerInputSDL::SetSettings(Settings const &settings)
+        {
+            bool const interval_changed =
+                    (settings.sample_interval != m_settings.sample_interval);
+
+            m_settings = settings;
+
+            if(interval_changed) {
+                m_timer.reset();
+                updateTimer();
+            }
+        }
+
+        GameControllerInputSDL::Settings const &
+        GameControllerInputSDL::GetSettings() const
+        {
+            return m_settings;
+        }
+
+        GameControllerInputSDL::Snapshot
+        GameControllerInputSDL::GetSnapshot() const
+        {
+            return m_snapshots.Read();
+        }
+
+        void GameControllerInputSDL::ProcessSDLEvent(SDL_Event const &sdl_event)
+        {
+            switch(sdl_event.type)
+            {
+                case SDL_CONTROLLERDEVICEADDED:
+                {
+                    // For this event, 'which' is the device index
+                    openController(sdl_event.cdevice.which);
+                    updateTimer();
+                    break;
+                }
+                case SDL_CONTROLLERDEVICEREMOVED:
+                {
+                    // For this event, 'which' is the instance id
+                    closeController(sdl_event.cdevice.which);
+                    updateTimer();
+                    break;
+                }
+                case SDL_CONTROLLERBUTTONDOWN:
+                {
+                    // Latch presses so that a press and release
+                    // between two samples isn't lost
+                    for(uint i=0; i < MaxControllers; i++) {
+                        if(m_list_sdl_controllers[i] &&
+                           m_list_instance_ids[i] == sdl_event.cbutton.which) {
+                            m_latched_buttons[i] |= (1 << sdl_event.cbutton.button);
+                            break;
+                        }
+                    }
+                    break;
+                }
+                default:
+                {
+                    break;
+                }
+            }
+        }
+
+        void GameControllerInputSDL::openController(int device_index)
+        {
+            SDL_GameController* sdl_controller =
+                    SDL_GameControllerOpen(device_index);
+
+            if(sdl_controller == nullptr) {
+                std::string const err_msg(SDL_GetError());
+                LOG.Warn() << "SDL: Failed to open game controller: "
+                           << err_msg;
+                return;
+            }
+
+            SDL_JoystickID const instance_id =
+                    SDL_JoystickInstanceID(
+                        SDL_GameControllerGetJoystick(sdl_controller));
+
+            // Already open; SDL refcounts opened controllers
+            // so release the extra reference
+            for(uint i=0; i < MaxControllers; i++) {
+                if(m_list_sdl_controllers[i] &&
+                   m_list_instance_ids[i] == instance_id) {
+                    SDL_GameControllerClose(sdl_controller);
+                    return;
+                }
+            }
+
+            for(uint i=0; i < MaxControllers; i++) {
+                if(m_list_sdl_controllers[i] == nullptr) {
+                    m_list_sdl_controllers[i] = sdl_controller;
+                    m_list_instance_ids[i] = instance_id;
+                    m_hotplugged = true;
+
+                    signal_controller_added.Emit(Id(instance_id));
+                    return;
+                }
+            }
+
+            LOG.Warn() << "SDL: Ignoring game controller, max of "
+                       << MaxControllers << " reached";
+
+            SDL_GameControllerClose(sdl_controller);
+        }
+
+        void GameControllerInputSDL::closeController(SDL_JoystickID instance_id)
+        {
+            for(uint i=0; i < MaxControllers; i++) {
+                if(m_list_sdl_controllers[i] &&
+                   m_list_instance_ids[i] == instance_id) {
+                    SDL_GameControllerClose(m_list_sdl_controllers[i]);
+                    m_list_sdl_controllers[i] = nullptr;
+                    m_list_instance_ids[i] = -1;
+
+                    for(uint a=0; a < AxisCount; a++) {
+                        m_raw_axes[i*AxisCount+a] = 0.0f;
+                        m_filtered_axes[i*AxisCount+a] = 0.0f;
+                    }
+                    m_buttons[i] = 0;
+                    m_latched_buttons[i] = 0;
+                    m_hotplugged = true;
+
+                    signal_controller_removed.Emit(Id(instance_id));
+                    return;
+                }
+            }
+        }
+
+        void GameControllerInputSDL::updateTimer()
+        {
+            // Only sample while there's something to sample
+            bool const any_open =
+                    std::any_of(
+                        m_list_sdl_controllers.begin(),
+                        m_list_sdl_controllers.end(),
+                        [](SDL_GameController* c) { return c != nullptr; });
+
+            if(any_open && !m_timer) {
+                m_timer.reset(
+                            new CallbackTimer(
+                                m_event_loop,
+                                m_settings.sample_interval,
+                                [this](){ this->sample(); }));
+                m_timer->Start();
+            }
+            else if(!any_open && m_timer) {
+                m_timer.reset();
+            }
+
+            // Publish hotplug changes right away rather
+            // than waiting for the next sample
+            if(m_hotplugged) {
+                sample();
+            }
+        }
+
+        void GameControllerInputSDL::sample()
+        {
+            SDL_GameControllerUpdate();
+
+            // Gather raw values for all controllers
+            bool changed = m_hotplugged;
+            m_hotplugged = false;
+
+            for(uint i=0; i < MaxControllers; i++) {
+                SDL_GameController* sdl_controller = m_list_sdl_controllers[i];
+                if(sdl_controller == nullptr) {
+                    continue;
+                }
+
+                for(uint a=0; a < AxisCount; a++) {
+                    m_raw_axes[i*AxisCount+a] =
+                            NormalizeSDLAxis(
+                                SDL_GameControllerGetAxis(
+                                    sdl_controller,
+                                    static_cast<SDL_GameControllerAxis>(a)));
+                }
+
+                u32 buttons = m_latched_buttons[i];
+                for(uint b=0; b < SDL_CONTROLLER_BUTTON_MAX; b++) {
+                    if(SDL_GameControllerGetButton(
+                                sdl_controller,
+                                static_cast<SDL_GameControllerButton>(b))) {
+                        buttons |= (1 << b);
+                    }
+                }
+                m_latched_buttons[i] = 0;
+
+                changed = changed || (buttons != m_buttons[i]);
+                m_buttons[i] = buttons;
+            }
+
+            // Filter all axes in one pass
+            auto const prev_filtered_axes = m_filtered_axes;
+            filterAxes();
+            changed = changed || (prev_filtered_axes != m_filtered_axes);
+
+            m_sample++;
+            if(!changed) {
+                return;
+            }
+
+            // Publish
+            Snapshot snapshot;
+            snapshot.sample = m_sample;
+            snapshot.timestamp = std::chrono::high_resolution_clock::now();
+
+            for(uint i=0; i < MaxControllers; i++) {
+                if(m_list_sdl_controllers[i] == nullptr) {
+                    continue;
+                }
+
+                Controller& controller =
+                        snapshot.list_controllers[snapshot.controller_count];
+
+                controller.id = Id(m_list_instance_ids[i]);
+                controller.connected = true;
+                controller.buttons = m_buttons[i];
+                for(uint a=0; a < AxisCount; a++) {
+                    controller.axes[a] = m_filtered_axes[i*AxisCount+a];
+                }
+
+                snapshot.controller_count++;
+            }
+
+            m_snapshots.Publish(snapshot);
+            signal_state_changed.Emit();
+        }
+
+        void GameControllerInputSDL::filterAxes()
+        {
+            float const stick_dz = m_settings.stick_deadzone;
+            float const trigger_dz = m_settings.trigger_deadzone;
+            float const smooth = m_settings.smoothing;
+
+            for(uint i=0; i < MaxControllers; i++) {
+                float* raw = &m_raw_axes[i*AxisCount];
+                float* filtered = &m_filtered_axes[i*AxisCount];
+
+                // Radial deadzone for both sticks
+                for(uint s=0; s < 2; s++) {
+                    uint const ax = (s == 0) ?
+                                uint(Axis::LeftX) : uint(Axis::RightX);
+                    uint const ay = ax+1;
+
+                    float const mag = std::sqrt(raw[ax]*raw[ax] + raw[ay]*raw[ay]);
+                    float scale = 0.0f;
+                    if(mag > stick_dz) {
+                        scale = ApplyLinearDeadzone(mag,stick_dz)/mag;
+                    }
+
+                    raw[ax] *= scale;
+                    raw[ay] *= scale;
+                }
+
+                raw[uint(Axis::TriggerLeft)] =
+                        ApplyLinearDeadzone(raw[uint(Axis::TriggerLeft)],trigger_dz);
+
+                raw[uint(Axis::TriggerRight)] =
+                        ApplyLinearDeadzone(raw[uint(Axis::TriggerRight)],trigger_dz);
+
+                // Smoothing; snap once close enough so a released
+                // stick settles instead of decaying forever
+                for(uint a=0; a < AxisCount; a++) {
+                    float const value = filtered[a]*smooth + raw[a]*(1.0f-smooth);
+                    filtered[a] = (std::fabs(value-raw[a]) < 1E-4f) ? raw[a] : value;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,180 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef KS_GUI_GAME_CONTROLLER_SDL_HPP
+#define KS_GUI_GAME_CONTROLLER_SDL_HPP
+
+#include <array>
+
+#include <SDL2/SDL.h>
+
+#include <ks/gui/KsGuiPlatform.hpp>
+#include <ks/shared/KsCallbackTimer.hpp>
+#include <ks/platform/KsPlatformSnapshotBuffer.hpp>
+
+namespace ks
+{
+    namespace gui
+    {
+        // GameControllerInputSDL
+        // * Tracks game controllers through SDL's game controller
+        //   API, including hotplugging
+        // * Axes and buttons are sampled on a timer on the app
+        //   event loop, independent of the frame rate. Deadzone
+        //   and smoothing filters are applied to every axis of
+        //   every controller in a single pass per sample
+        // * Each sample that changes anything is published as a
+        //   Snapshot that can be read from any thread without
+        //   locking, and signal_state_changed is emitted once;
+        //   there are no per-axis or per-button signals
+        class GameControllerInputSDL final
+        {
+        public:
+            static uint const MaxControllers = 8;
+            static uint const AxisCount = SDL_CONTROLLER_AXIS_MAX;
+
+            enum class Axis : uint
+            {
+                LeftX = SDL_CONTROLLER_AXIS_LEFTX,
+                LeftY = SDL_CONTROLLER_AXIS_LEFTY,
+                RightX = SDL_CONTROLLER_AXIS_RIGHTX,
+                RightY = SDL_CONTROLLER_AXIS_RIGHTY,
+                TriggerLeft = SDL_CONTROLLER_AXIS_TRIGGERLEFT,
+                TriggerRight = SDL_CONTROLLER_AXIS_TRIGGERRIGHT
+            };
+
+            // Bit flags for Controller::buttons
+            enum Button : u32
+            {
+                BUTTON_A = 1 << SDL_CONTROLLER_BUTTON_A,
+                BUTTON_B = 1 << SDL_CONTROLLER_BUTTON_B,
+                BUTTON_X = 1 << SDL_CONTROLLER_BUTTON_X,
+                BUTTON_Y = 1 << SDL_CONTROLLER_BUTTON_Y,
+                BUTTON_BACK = 1 << SDL_CONTROLLER_BUTTON_BACK,
+                BUTTON_GUIDE = 1 << SDL_CONTROLLER_BUTTON_GUIDE,
+                BUTTON_START = 1 << SDL_CONTROLLER_BUTTON_START,
+                BUTTON_LEFT_STICK = 1 << SDL_CONTROLLER_BUTTON_LEFTSTICK,
+                BUTTON_RIGHT_STICK = 1 << SDL_CONTROLLER_BUTTON_RIGHTSTICK,
+                BUTTON_LEFT_SHOULDER = 1 << SDL_CONTROLLER_BUTTON_LEFTSHOULDER,
+                BUTTON_RIGHT_SHOULDER = 1 << SDL_CONTROLLER_BUTTON_RIGHTSHOULDER,
+                BUTTON_DPAD_UP = 1 << SDL_CONTROLLER_BUTTON_DPAD_UP,
+                BUTTON_DPAD_DOWN = 1 << SDL_CONTROLLER_BUTTON_DPAD_DOWN,
+                BUTTON_DPAD_LEFT = 1 << SDL_CONTROLLER_BUTTON_DPAD_LEFT,
+                BUTTON_DPAD_RIGHT = 1 << SDL_CONTROLLER_BUTTON_DPAD_RIGHT
+            };
+
+            struct Settings
+            {
+                // Interval between samples
+                Milliseconds sample_interval{4};
+
+                // Radial deadzone applied to each stick and linear
+                // deadzone applied to each trigger, as a fraction
+                // of the full axis range. Values outside the deadzone
+                // are rescaled so the output still covers [0,1]
+                float stick_deadzone{0.15f};
+                float trigger_deadzone{0.05f};
+
+                // Exponential smoothing weight given to the previous
+                // filtered value; 0 disables smoothing
+                float smoothing{0.0f};
+            };
+
+            struct Controller
+            {
+                // SDL joystick instance id
+                Id id{0};
+                bool connected{false};
+
+                // Sticks are in [-1,1], triggers in [0,1]
+                std::array<float,AxisCount> axes{};
+
+                // Buttons that were down at any point since
+                // the previous sample (see Button)
+                u32 buttons{0};
+            };
+
+            struct Snapshot
+            {
+                u64 sample{0};
+                TimePoint timestamp;
+                uint controller_count{0};
+                std::array<Controller,MaxControllers> list_controllers{};
+            };
+
+            GameControllerInputSDL(shared_ptr<EventLoop> event_loop);
+            ~GameControllerInputSDL();
+
+            // Must be called from the app event loop thread
+            void SetSettings(Settings const &settings);
+            Settings const & GetSettings() const;
+
+            // Any thread
+            Snapshot GetSnapshot() const;
+
+            // Called by PlatformSDL for controller device
+            // and button events
+            void ProcessSDLEvent(SDL_Event const &sdl_event);
+
+            // * Controllers that are attached when this is created
+            //   are also announced through signal_controller_added,
+            //   from the next ProcessEvents after construction
+            Signal<Id> signal_controller_added;
+            Signal<Id> signal_controller_removed;
+            Signal<> signal_state_changed;
+
+        private:
+#if SDL_VERSION_ATLEAST(2,0,10)
+            static uint const JoystickEventCount = 5;
+#else
+            static uint const JoystickEventCount = 4;
+#endif
+
+            void openController(int device_index);
+            void closeController(SDL_JoystickID instance_id);
+            void updateTimer();
+            void sample();
+            void filterAxes();
+
+            shared_ptr<EventLoop> m_event_loop;
+            Settings m_settings;
+            unique_ptr<CallbackTimer> m_timer;
+
+            // Slots are stable while a controller is connected;
+            // a null entry is an unused slot
+            std::array<SDL_GameController*,MaxControllers> m_list_sdl_controllers;
+            std::array<SDL_JoystickID,MaxControllers> m_list_instance_ids;
+
+            // Flat per-sample buffers, indexed by
+            // slot*AxisCount+axis for the axes
+            std::array<float,MaxControllers*AxisCount> m_raw_axes;
+            std::array<float,MaxControllers*AxisCount> m_filtered_axes;
+            std::array<u32,MaxControllers> m_buttons;
+            std::array<u32,MaxControllers> m_latched_buttons;
+
+            // Event states to restore on destruction
+            Uint8 m_prev_axis_motion_state;
+            Uint8 m_prev_button_up_state;
+            std::array<Uint8,JoystickEventCount> m_prev_joystick_states;
+
+            bool m_hotplugged;
+            u64 m_sample;
+            SnapshotBuffer<Snapshot> m_snapshots;
+        };
+    }
+}
+
+#endif // KS_GUI_GAME_CONTROLLER_SDL_HPP
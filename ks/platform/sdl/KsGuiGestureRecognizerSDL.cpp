@@ -0,0 +1,248 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <cmath>
+
+#include <ks/platform/sdl/KsGuiGestureRecognizerSDL.hpp>
+
+namespace ks
+{
+    namespace gui
+    {
+        namespace
+        {
+            float const k_pi = 3.14159265358979f;
+
+            float WrapAngle(float radians)
+            {
+                if(radians > k_pi) {
+                    return radians-2.0f*k_pi;
+                }
+                if(radians < -k_pi) {
+                    return radians+2.0f*k_pi;
+                }
+                return radians;
+            }
+        }
+
+        GestureRecognizerSDL::GestureRecognizerSDL() :
+            m_prev_mask(0),
+            m_touch_count(0),
+            m_centroid_x(0.0f),
+            m_centroid_y(0.0f)
+        {
+            m_prev_x.fill(0.0f);
+            m_prev_y.fill(0.0f);
+        }
+
+        void GestureRecognizerSDL::SetSettings(Settings const &settings)
+        {
+            m_settings = settings;
+        }
+
+        GestureRecognizerSDL::Settings const &
+        GestureRecognizerSDL::GetSettings() const
+        {
+            return m_settings;
+        }
+
+        void GestureRecognizerSDL::Update(TouchTrackerSDL::Snapshot const &snapshot,
+                                          TimePoint const &timestamp)
+        {
+            u32 const active_mask = snapshot.active_mask;
+
+            // Nothing to do while idle
+            if(active_mask == 0 && m_prev_mask == 0 &&
+               !m_pan.active && !m_pinch.active && !m_rotate.active) {
+                return;
+            }
+
+            u32 const common_mask = active_mask & m_prev_mask;
+
+            // Centroid of all contacts that are down, and centroids
+            // of the contacts that were also down last frame
+            uint touch_count = 0;
+            float cx = 0.0f;
+            float cy = 0.0f;
+
+            uint common_count = 0;
+            float cx0 = 0.0f;
+            float cy0 = 0.0f;
+            float cx1 = 0.0f;
+            float cy1 = 0.0f;
+
+            for(uint i=0; i < TouchTrackerSDL::MaxTouches; i++) {
+                u32 const bit = (1u << i);
+                if(active_mask & bit) {
+                    touch_count++;
+                    cx += snapshot.x[i];
+                    cy += snapshot.y[i];
+                }
+                if(common_mask & bit) {
+                    common_count++;
+                    cx0 += m_prev_x[i];
+                    cy0 += m_prev_y[i];
+                    cx1 += snapshot.x[i];
+                    cy1 += snapshot.y[i];
+                }
+            }
+
+            m_timestamp = timestamp;
+            m_touch_count = touch_count;
+            if(touch_count > 0) {
+                m_centroid_x = cx/touch_count;
+                m_centroid_y = cy/touch_count;
+            }
+
+            float dx = 0.0f;
+            float dy = 0.0f;
+            float frame_scale = 1.0f;
+            float frame_rotation = 0.0f;
+
+            if(common_count > 0) {
+                cx0 /= common_count;
+                cy0 /= common_count;
+                cx1 /= common_count;
+                cy1 /= common_count;
+                dx = cx1-cx0;
+                dy = cy1-cy0;
+            }
+
+            if(common_count > 1) {
+                // Mean distance from and mean change in angle
+                // around the centroid
+                float spread0 = 0.0f;
+                float spread1 = 0.0f;
+
+                for(uint i=0; i < TouchTrackerSDL::MaxTouches; i++) {
+                    if((common_mask & (1u << i)) == 0) {
+                        continue;
+                    }
+
+                    float const x0 = m_prev_x[i]-cx0;
+                    float const y0 = m_prev_y[i]-cy0;
+                    float const x1 = snapshot.x[i]-cx1;
+                    float const y1 = snapshot.y[i]-cy1;
+
+                    spread0 += std::sqrt(x0*x0 + y0*y0);
+                    spread1 += std::sqrt(x1*x1 + y1*y1);
+                    frame_rotation += WrapAngle(std::atan2(y1,x1)-std::atan2(y0,x0));
+                }
+
+                if(spread0 > 1E-3f) {
+                    frame_scale = spread1/spread0;
+                }
+                frame_rotation /= common_count;
+            }
+
+            m_prev_mask = active_mask;
+            m_prev_x = snapshot.x;
+            m_prev_y = snapshot.y;
+
+            // Pan
+            if(touch_count == 0) {
+                end(GestureEvent::Type::Pan,m_pan);
+            }
+            else if(common_count > 0) {
+                m_pan.dx += dx;
+                m_pan.dy += dy;
+
+                if(!m_pan.active) {
+                    float const dist = std::sqrt(m_pan.dx*m_pan.dx + m_pan.dy*m_pan.dy);
+                    if(dist >= m_settings.pan_threshold_px) {
+                        m_pan.active = true;
+                        emit(GestureEvent::Type::Pan,
+                             GestureEvent::State::Began,
+                             m_pan,m_pan.dx,m_pan.dy);
+                    }
+                }
+                else if(dx != 0.0f || dy != 0.0f) {
+                    emit(GestureEvent::Type::Pan,
+                         GestureEvent::State::Changed,
+                         m_pan,dx,dy);
+                }
+            }
+
+            // Pinch and rotate
+            if(touch_count < 2) {
+                end(GestureEvent::Type::Pinch,m_pinch);
+                end(GestureEvent::Type::Rotate,m_rotate);
+            }
+            else if(common_count > 1) {
+                m_pinch.scale *= frame_scale;
+                m_rotate.rotation += frame_rotation;
+
+                if(!m_pinch.active) {
+                    if(std::fabs(m_pinch.scale-1.0f) >= m_settings.pinch_threshold) {
+                        m_pinch.active = true;
+                        emit(GestureEvent::Type::Pinch,
+                             GestureEvent::State::Began,
+                             m_pinch,0.0f,0.0f);
+                    }
+                }
+                else if(frame_scale != 1.0f) {
+                    emit(GestureEvent::Type::Pinch,
+                         GestureEvent::State::Changed,
+                         m_pinch,0.0f,0.0f);
+                }
+
+                if(!m_rotate.active) {
+                    if(std::fabs(m_rotate.rotation) >= m_settings.rotate_threshold) {
+                        m_rotate.active = true;
+                        emit(GestureEvent::Type::Rotate,
+                             GestureEvent::State::Began,
+                             m_rotate,0.0f,0.0f);
+                    }
+                }
+                else if(frame_rotation != 0.0f) {
+                    emit(GestureEvent::Type::Rotate,
+                         GestureEvent::State::Changed,
+                         m_rotate,0.0f,0.0f);
+                }
+            }
+        }
+
+        void GestureRecognizerSDL::emit(GestureEvent::Type type,
+                                        GestureEvent::State state,
+                                        Tracking const &tracking,
+                                        float dx,
+                                        float dy)
+        {
+            GestureEvent gesture;
+            gesture.type = type;
+            gesture.state = state;
+            gesture.timestamp = m_timestamp;
+            gesture.touch_count = m_touch_count;
+            gesture.x = m_centroid_x;
+            gesture.y = m_centroid_y;
+            gesture.dx = dx;
+            gesture.dy = dy;
+            gesture.scale = tracking.scale;
+            gesture.rotation = tracking.rotation;
+
+            signal_gesture.Emit(gesture);
+        }
+
+        void GestureRecognizerSDL::end(GestureEvent::Type type, Tracking &tracking)
+        {
+            if(tracking.active) {
+                emit(type,GestureEvent::State::Ended,tracking,0.0f,0.0f);
+            }
+
+            tracking = Tracking();
+        }
+    }
+}
@@ -0,0 +1,137 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef KS_GUI_GESTURE_RECOGNIZER_SDL_HPP
+#define KS_GUI_GESTURE_RECOGNIZER_SDL_HPP
+
+#include <ks/gui/KsGuiPlatform.hpp>
+#include <ks/platform/sdl/KsGuiTouchTrackerSDL.hpp>
+
+namespace ks
+{
+    namespace gui
+    {
+        struct GestureEvent
+        {
+            enum class Type
+            {
+                Pan,
+                Pinch,
+                Rotate
+            };
+
+            enum class State
+            {
+                Began,
+                Changed,
+                Ended
+            };
+
+            Type type;
+            State state;
+            TimePoint timestamp;
+
+            // Number of contacts down
+            uint touch_count;
+
+            // Centroid of the contacts in pixels
+            float x;
+            float y;
+
+            // Pan: translation since the previous update
+            float dx;
+            float dy;
+
+            // Pinch: scale relative to when the gesture began
+            float scale;
+
+            // Rotate: clockwise radians relative to when
+            // the gesture began
+            float rotation;
+        };
+
+        // GestureRecognizerSDL
+        // * Recognizes pan, pinch and rotate gestures from the
+        //   touch contacts of each frame as a whole rather than
+        //   from individual touch events
+        // * Only contacts that are down in both the previous and
+        //   the current frame contribute to a frame's deltas, so
+        //   adding or lifting a finger doesn't cause a jump
+        // * signal_gesture is emitted at most once per gesture
+        //   type per frame; no allocations are made per frame
+        class GestureRecognizerSDL final
+        {
+        public:
+            struct Settings
+            {
+                // Thresholds that must be crossed before
+                // a gesture begins
+                float pan_threshold_px{10.0f};
+                float pinch_threshold{0.05f};
+                float rotate_threshold{0.1f};
+            };
+
+            GestureRecognizerSDL();
+
+            void SetSettings(Settings const &settings);
+            Settings const & GetSettings() const;
+
+            // Called once per frame with the touch tracker's
+            // snapshot after the frame's events are processed
+            void Update(TouchTrackerSDL::Snapshot const &snapshot,
+                        TimePoint const &timestamp);
+
+            Signal<GestureEvent> signal_gesture;
+
+        private:
+            struct Tracking
+            {
+                bool active{false};
+                float dx{0.0f};
+                float dy{0.0f};
+                float scale{1.0f};
+                float rotation{0.0f};
+            };
+
+            void emit(GestureEvent::Type type,
+                      GestureEvent::State state,
+                      Tracking const &tracking,
+                      float dx,
+                      float dy);
+
+            void end(GestureEvent::Type type, Tracking &tracking);
+
+            Settings m_settings;
+
+            // Contacts and positions from the previous frame
+            u32 m_prev_mask;
+            std::array<float,TouchTrackerSDL::MaxTouches> m_prev_x;
+            std::array<float,TouchTrackerSDL::MaxTouches> m_prev_y;
+
+            Tracking m_pan;
+            Tracking m_pinch;
+            Tracking m_rotate;
+
+            // Filled in per Update for emit()
+            TimePoint m_timestamp;
+            uint m_touch_count;
+            float m_centroid_x;
+            float m_centroid_y;
+        };
+    }
+}
+
+#endif // KS_GUI_GESTURE_RECOGNIZER_SDL_HPP
@@ -0,0 +1,99 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef KS_GUI_INPUT_STATE_SDL_HPP
+#define KS_GUI_INPUT_STATE_SDL_HPP
+
+#include <array>
+
+#include <SDL2/SDL.h>
+
+#include <ks/gui/KsGuiInput.hpp>
+#include <ks/platform/sdl/KsGuiTouchTrackerSDL.hpp>
+
+namespace ks
+{
+    namespace gui
+    {
+        // InputState
+        // * The state of the keyboard, pointer and touch contacts
+        //   as of the end of a ProcessEvents call
+        // * PlatformSDL publishes one of these per ProcessEvents
+        //   so that other threads can poll input without
+        //   reconstructing it from the input signals
+        struct InputState
+        {
+            static uint const KeyWordCount = (SDL_NUM_SCANCODES+63)/64;
+
+            // Bit flags for Pointer::buttons
+            enum PointerButton : u32
+            {
+                POINTER_LEFT = 1 << 0,
+                POINTER_RIGHT = 1 << 1,
+                POINTER_MIDDLE = 1 << 2
+            };
+
+            struct Pointer
+            {
+                // SDL window id of the window the pointer
+                // was last reported in
+                Id window_id{0};
+
+                sint x{0};
+                sint y{0};
+                u32 buttons{0};
+            };
+
+            u64 frame{0};
+            TimePoint timestamp;
+
+            // Keys that are down, one bit per KeyEvent::scancode
+            std::array<u64,KeyWordCount> keys{};
+
+            // KeyEvent::MOD_* flags from the last key event
+            uint mods{0};
+
+            Pointer pointer;
+
+            TouchTrackerSDL::Snapshot touches;
+
+            bool IsKeyDown(uint scancode) const
+            {
+                if(scancode >= KeyWordCount*64) {
+                    return false;
+                }
+                return (keys[scancode/64] >> (scancode%64)) & 1;
+            }
+
+            void SetKeyDown(uint scancode, bool down)
+            {
+                if(scancode >= KeyWordCount*64) {
+                    return;
+                }
+
+                u64 const bit = u64(1) << (scancode%64);
+                if(down) {
+                    keys[scancode/64] |= bit;
+                }
+                else {
+                    keys[scancode/64] &= ~bit;
+                }
+            }
+        };
+    }
+}
+
+#endif // KS_GUI_INPUT_STATE_SDL_HPP
@@ -14,15 +14,13 @@
    limitations under the License.
 */
 
-#include <ks/gl/KsGLConfig.hpp>
-
-#include <SDL2/SDL.h>
+#include <ks/platform/sdl/KsGuiPlatformSDL.hpp>
 
 #include <ks/KsTimer.hpp>
-#include <ks/gui/KsGuiPlatform.hpp>
 #include <ks/shared/KsCallbackTimer.hpp>
 
 #include <ks/platform/sdl/KsGuiConvertSDLInputs.hpp>
+#include <ks/platform/sdl/KsGuiGLFunctionLoaderSDL.hpp>
 
 #if defined(KS_ENV_ANDROID)
 
@@ -129,20 +127,31 @@ namespace ks
 {
     namespace gui
     {
+        namespace
+        {
+            // Dirty rects kept per software frame before
+            // they're merged into their bounding rect
+            std::size_t const k_max_dirty_rects = 32;
+        }
+
         // ============================================================= //
         // ============================================================= //
 
-        class PlatformWindowSDL : public IPlatformWindow
-        {
-        public:
-            PlatformWindowSDL(Window::Attributes& attrs,
-                              Window::Properties& props,
-                              bool load_gl_fns)
+            PlatformWindowSDL::PlatformWindowSDL(Window::Attributes& attrs,
+                                                 Window::Properties& props,
+                                                 bool software,
+                                                 LatencyProfile profile) :
+                m_software(software)
             {
+                m_latency_result.profile = profile;
+                bool const low_latency = (profile == LatencyProfile::LowLatency);
+
                 // set SDL window construction flags
                 Uint32 window_flags=0;
 
-                window_flags |= SDL_WINDOW_OPENGL;
+                if(!m_software) {
+                    window_flags |= SDL_WINDOW_OPENGL;
+                }
 
                 if(attrs.resizable) {
                     window_flags |= SDL_WINDOW_RESIZABLE;
@@ -151,7 +160,10 @@ namespace ks
                     window_flags |= SDL_WINDOW_BORDERLESS;
                 }
                 if(props.fullscreen == Window::FullscreenMode::Desktop) {
-                    window_flags |= SDL_WINDOW_FULLSCREEN_DESKTOP;
+                    // Exclusive fullscreen lets the display scan out the
+                    // window's buffers directly
+                    window_flags |= low_latency ?
+                                SDL_WINDOW_FULLSCREEN : SDL_WINDOW_FULLSCREEN_DESKTOP;
                 }
                 if(props.fullscreen == Window::FullscreenMode::Display) {
                     window_flags |= SDL_WINDOW_FULLSCREEN;
@@ -205,6 +217,23 @@ namespace ks
                                         SDL_GL_CONTEXT_FORWARD_COMPATIBLE_FLAG);
                 }
 
+#ifdef SDL_HINT_VIDEO_X11_NET_WM_BYPASS_COMPOSITOR
+                // SDL reads the hint when it creates a window, so it's
+                // set just for this window and restored afterwards
+                std::string prev_bypass_hint;
+                bool restore_bypass_hint = false;
+                if(low_latency) {
+                    char const * hint = SDL_GetHint(SDL_HINT_VIDEO_X11_NET_WM_BYPASS_COMPOSITOR);
+                    if(hint) {
+                        prev_bypass_hint = hint;
+                        restore_bypass_hint = true;
+                    }
+
+                    // Fails if overridden by the environment
+                    SDL_SetHint(SDL_HINT_VIDEO_X11_NET_WM_BYPASS_COMPOSITOR,"1");
+                }
+#endif
+
                 // create the window and context
                 m_window = SDL_CreateWindow(
                             props.title.c_str(),
@@ -214,44 +243,96 @@ namespace ks
                             props.height,
                             window_flags);
 
+                if(m_window == nullptr && low_latency &&
+                   props.fullscreen == Window::FullscreenMode::Desktop) {
+                    LOG.Warn() << "SDL: Failed to create exclusive fullscreen "
+                                  "window, using desktop fullscreen: "
+                               << SDL_GetError();
+
+                    window_flags |= SDL_WINDOW_FULLSCREEN_DESKTOP;
+
+                    m_window = SDL_CreateWindow(
+                                props.title.c_str(),
+                                props.x,
+                                props.y,
+                                props.width,
+                                props.height,
+                                window_flags);
+                }
+
+#ifdef SDL_HINT_VIDEO_X11_NET_WM_BYPASS_COMPOSITOR
+                if(low_latency) {
+                    char const * video_driver = SDL_GetCurrentVideoDriver();
+                    m_latency_result.compositor_bypass =
+                            (m_window != nullptr) &&
+                            (video_driver != nullptr) &&
+                            (std::string(video_driver) == "x11") &&
+                            SDL_GetHintBoolean(SDL_HINT_VIDEO_X11_NET_WM_BYPASS_COMPOSITOR,
+                                               SDL_TRUE);
+
+                    if(restore_bypass_hint) {
+                        SDL_SetHint(SDL_HINT_VIDEO_X11_NET_WM_BYPASS_COMPOSITOR,
+                                    prev_bypass_hint.c_str());
+                    }
+                    else {
+                        // Back to unset
+#if SDL_VERSION_ATLEAST(2,24,0)
+                        SDL_ResetHint(SDL_HINT_VIDEO_X11_NET_WM_BYPASS_COMPOSITOR);
+#else
+                        SDL_SetHint(SDL_HINT_VIDEO_X11_NET_WM_BYPASS_COMPOSITOR,nullptr);
+#endif
+                    }
+                }
+#endif
+
                 if(m_window == nullptr) {
                     std::string const err_msg(SDL_GetError());
                     throw WindowCreationFailed(
                                 "SDL: Failed to create window: "+err_msg);
                 }
 
-                m_context = SDL_GL_CreateContext(m_window);
-                if(m_context == nullptr) {
-                    std::string const err_msg(SDL_GetError());
-                    throw WindowCreationFailed(
-                                "SDL: Failed to create context: "+err_msg);
-                }
+                m_context = nullptr;
+                m_context_window = m_window;
+
+                if(!m_software) {
+                    m_context = SDL_GL_CreateContext(m_window);
+                    if(m_context == nullptr) {
+                        std::string const err_msg(SDL_GetError());
+                        throw WindowCreationFailed(
+                                    "SDL: Failed to create context: "+err_msg);
+                    }
 
-                // load opengl functions
-                // TODO Do we have to load the OpenGL functions
-                // for every new context?
-                #ifdef KS_ENV_GL_LOAD_FUNCPTRS
-                    if(load_gl_fns) {
-                        if(!gladLoadGL()) {
-                            throw WindowCreationFailed(
-                                        "glad: Could not load OpenGL functions");
+                    // OpenGL functions are loaded for the context the
+                    // first time MakeContextCurrent is called with it
+                    // (see GLFunctionLoaderSDL)
+
+                    // set the vsync interval
+                    // TODO: Should this only be called once per
+                    // per application? Does multiple swap intervals
+                    // for different contexts in a single application
+                    // make any sense?
+                    bool adaptive_vsync = false;
+                    if(low_latency && props.swap_interval != 0) {
+                        // Adaptive vsync swaps immediately when a frame
+                        // misses its vblank instead of waiting a whole
+                        // refresh for the next one
+                        adaptive_vsync = (SDL_GL_SetSwapInterval(-1) == 0);
+                        if(!adaptive_vsync) {
+                            LOG.Trace() << "SDL: Adaptive vsync unsupported: "
+                                        << SDL_GetError();
                         }
                     }
-                #else
-                    (void)load_gl_fns;
-                #endif
 
-                // set the vsync interval
-                // TODO: Should this only be called once per
-                // per application? Does multiple swap intervals
-                // for different contexts in a single application
-                // make any sense?
-                if(SDL_GL_SetSwapInterval(props.swap_interval) != 0) {
-                    std::string const err_msg(SDL_GetError());
-                    LOG.Warn() << "SDL: Failed to set swap interval to "
-                               << props.swap_interval;
+                    if(!adaptive_vsync &&
+                       SDL_GL_SetSwapInterval(props.swap_interval) != 0) {
+                        std::string const err_msg(SDL_GetError());
+                        LOG.Warn() << "SDL: Failed to set swap interval to "
+                                   << props.swap_interval;
+
+                        LOG.Warn() << "SDL: " << err_msg;
+                    }
 
-                    LOG.Warn() << "SDL: " << err_msg;
+                    m_latency_result.swap_interval = SDL_GL_GetSwapInterval();
                 }
 
                 // save the actual parameters received
@@ -260,6 +341,8 @@ namespace ks
                 SDL_GetWindowSize(m_window,&window_w,&window_h);
                 props.width = window_w;
                 props.height = window_h;
+                m_size = Window::Size(window_w,window_h);
+                m_pending_size = m_size;
 
                 int window_x,window_y;
                 SDL_GetWindowPosition(m_window,&window_x,&window_y);
@@ -284,6 +367,28 @@ namespace ks
                 // props.focused = ((window_flags & SDL_WINDOW_INPUT_FOCUS) == SDL_WINDOW_INPUT_FOCUS);
                 props.visible = ((window_flags & SDL_WINDOW_SHOWN) == SDL_WINDOW_SHOWN);
 
+                m_shown = props.visible;
+                m_minimized = ((window_flags & SDL_WINDOW_MINIMIZED) == SDL_WINDOW_MINIMIZED);
+                m_focused = ((window_flags & SDL_WINDOW_INPUT_FOCUS) == SDL_WINDOW_INPUT_FOCUS);
+
+                m_latency_result.exclusive_fullscreen =
+                        ((window_flags & SDL_WINDOW_FULLSCREEN_DESKTOP) == SDL_WINDOW_FULLSCREEN);
+
+                if(low_latency) {
+                    LOG.Trace() << "SDL: Low latency window: compositor bypass: "
+                                << m_latency_result.compositor_bypass
+                                << ", exclusive fullscreen: "
+                                << m_latency_result.exclusive_fullscreen
+                                << ", swap interval: "
+                                << m_latency_result.swap_interval;
+                }
+
+                if(m_software) {
+                    // There's no context to query; the surface format
+                    // is only known once the framebuffer is fetched
+                    return;
+                }
+
                 int gl_attr_red_bits;
                 int gl_attr_green_bits;
                 int gl_attr_blue_bits;
@@ -348,32 +453,39 @@ namespace ks
                 this->ReleaseContext();
             }
 
-            ~PlatformWindowSDL()
+            PlatformWindowSDL::~PlatformWindowSDL()
             {
 
             }
 
-            bool IsCurrentContext()
+            void PlatformWindowSDL::makeContextCurrent()
             {
-                return (SDL_GL_GetCurrentContext() == m_context);
-            }
-
-            void MakeContextCurrent()
-            {
-                if(SDL_GL_GetCurrentContext() == m_context) {
-                    return;
+                requireContext("MakeContextCurrent");
+
+                if(SDL_GL_GetCurrentContext() != m_context) {
+                    auto err = SDL_GL_MakeCurrent(m_context_window,m_context);
+                    if(err != 0) {
+                        std::string err_msg(SDL_GetError());
+                        throw WindowContextMakeCurrentError(
+                                    "SDL: MakeCurrent failed: "+err_msg);
+                    }
                 }
 
-                auto err = SDL_GL_MakeCurrent(m_window,m_context);
-                if(err != 0) {
-                    std::string err_msg(SDL_GetError());
+                // Also reloads the global function pointers if the
+                // last context that loaded them was a different kind
+                if(!GLFunctionLoaderSDL::Load(m_context)) {
                     throw WindowContextMakeCurrentError(
-                                "SDL: MakeCurrent failed: "+err_msg);
+                                "SDL: Could not load OpenGL functions");
                 }
+                m_gl_loaded = true;
             }
 
-            void ReleaseContext()
+            void PlatformWindowSDL::ReleaseContext()
             {
+                if(m_software) {
+                    return;
+                }
+
                 auto err = SDL_GL_MakeCurrent(NULL,NULL);
                 if(err != 0) {
                     std::string err_msg(SDL_GetError());
@@ -382,25 +494,63 @@ namespace ks
                 }
             }
 
-            void SwapBuffers()
+            void PlatformWindowSDL::presentScaled()
+            {
+                int width,height;
+                SDL_GL_GetDrawableSize(m_window,&width,&height);
+                m_scaler->Present(width,height);
+                m_resolution_scale = m_scaler->GetScale();
+            }
+
+            void PlatformWindowSDL::stopFailedPresentThread()
+            {
+                LOG.Warn() << "PlatformWindowSDL: The present thread failed, "
+                              "swapping on the render thread instead";
+
+                // Makes the window's context current so the
+                // caller can swap directly
+                StopPresentThread();
+            }
+
+            void PlatformWindowSDL::captureFrame()
             {
-                SDL_GL_SwapWindow(m_window);
+                int width,height;
+                SDL_GL_GetDrawableSize(m_window,&width,&height);
+                m_capture->Capture(width,height);
             }
 
-            void SetSize(Window::Size const &size)
+            void PlatformWindowSDL::SetSize(Window::Size const &size)
             {
                 SDL_SetWindowSize(m_window,size.first,size.second);
+
+                // SDL will also send a SIZE_CHANGED event; setting
+                // the size here prevents a second emit for it
+                m_size = size;
+                m_pending_size = size;
                 signal_size_changed.Emit(size);
+                Invalidate();
             }
 
-            void SetPosition(Window::Position const &position)
+            void PlatformWindowSDL::SetPosition(Window::Position const &position)
             {
                 SDL_SetWindowPosition(m_window,position.first,position.second);
                 signal_position_changed.Emit(position);
             }
 
-            void SetFullscreen(Window::FullscreenMode fullscreen)
+            void PlatformWindowSDL::SetFullscreen(Window::FullscreenMode fullscreen)
             {
+                if(fullscreen == Window::FullscreenMode::Desktop &&
+                   m_latency_result.profile == LatencyProfile::LowLatency) {
+                    if(SDL_SetWindowFullscreen(m_window,SDL_WINDOW_FULLSCREEN) == 0) {
+                        m_latency_result.exclusive_fullscreen = true;
+                        signal_fullscreen_changed.Emit(Window::FullscreenMode::Display);
+                        return;
+                    }
+
+                    LOG.Warn() << "SDL: Failed to set exclusive fullscreen, "
+                                  "using desktop fullscreen: " << SDL_GetError();
+                }
+
                 Uint32 flags=0;
 
                 if(fullscreen == Window::FullscreenMode::Display) {
@@ -417,10 +567,13 @@ namespace ks
                                 "SDL: Failed to set fullscreen mode: "+err_msg);
                 }
 
+                m_latency_result.exclusive_fullscreen =
+                        (fullscreen == Window::FullscreenMode::Display);
+
                 signal_fullscreen_changed.Emit(fullscreen);
             }
 
-            void SetFocused(bool)
+            void PlatformWindowSDL::SetFocused(bool)
             {
                 // TODO: window focus: Not sure if this option
                 // exists in SDL (SetWindowGrab?)
@@ -428,7 +581,7 @@ namespace ks
                             "SDL: Setting focus unsupported");
             }
 
-            void SetVisible(bool visible)
+            void PlatformWindowSDL::SetVisible(bool visible)
             {
                 if(visible) {
                     SDL_ShowWindow(m_window);
@@ -437,16 +590,21 @@ namespace ks
                     SDL_HideWindow(m_window);
                 }
 
+                // Prevents a second emit for SDL's SHOWN/HIDDEN event
+                m_shown = visible;
                 signal_visible_changed.Emit(visible);
+                if(visible) {
+                    Invalidate();
+                }
             }
 
-            void SetAlwaysOnTop(bool)
+            void PlatformWindowSDL::SetAlwaysOnTop(bool)
             {
                 throw WindowSettingFailed(
                             "SDL: Setting Always On Top unsupported");
             }
 
-            void SetSwapInterval(uint swap_interval)
+            void PlatformWindowSDL::SetSwapInterval(uint swap_interval)
             {
                 if(SDL_GL_SetSwapInterval(swap_interval) != 0) {
                     std::string const err_msg(SDL_GetError());
@@ -457,521 +615,2271 @@ namespace ks
                 signal_swap_interval_changed.Emit(swap_interval);
             }
 
-            void SetTitle(std::string const &title)
+            void PlatformWindowSDL::SetTitle(std::string const &title)
             {
                 SDL_SetWindowTitle(m_window,title.c_str());
                 signal_title_changed.Emit(title);
             }
 
-            void Destroy()
+            void PlatformWindowSDL::Destroy()
             {
+                if(!m_software) {
+                    // The present thread must stop before the window
+                    // it swaps goes away, and GL objects have to be
+                    // deleted while their context is still current.
+                    // If it can't be made current the objects are
+                    // leaked rather than deleted in whatever context
+                    // is current instead
+                    bool const context_current =
+                            (SDL_GL_MakeCurrent(m_context_window,m_context) == 0 &&
+                             GLFunctionLoaderSDL::Load(m_context));
+
+                    if(!context_current) {
+                        LOG.Warn() << "PlatformWindowSDL: Failed to make the "
+                                      "context current to destroy it, its "
+                                      "objects are leaked: " << SDL_GetError();
+
+                        if(m_capture) {
+                            m_capture->ForgetGLObjects();
+                        }
+                        if(m_scaler) {
+                            m_scaler->ForgetGLObjects();
+                        }
+                        if(m_present) {
+                            m_present->ForgetGLObjects();
+                        }
+                    }
+
+                    m_capture.reset();
+                    m_scaler.reset();
+                    clearFrameFences(context_current);
+                    StopPresentThread();
+                }
+
                 SDL_DestroyWindow(m_window);
+                GLFunctionLoaderSDL::RemoveContext(m_context);
                 SDL_GL_DeleteContext(m_context);
             }
 
-            SDL_Window* GetSDLWindow()
+            SDL_Window* PlatformWindowSDL::GetSDLWindow()
             {
                 return m_window;
             }
 
-            void SetSDLGLContext(SDL_GLContext context)
+            void PlatformWindowSDL::SetSDLGLContext(SDL_GLContext context)
             {
+                GLFunctionLoaderSDL::RemoveContext(m_context);
                 m_context = context;
-            }
-
-        private:
-            SDL_Window* m_window;
-            SDL_GLContext m_context;
-        };
-
-        // ============================================================= //
-        // ============================================================= //
-
-        namespace
-        {
-            // We need to access this for handleAppPriorityEvents
-            shared_ptr<EventLoop> g_app_event_loop;
-        }
-
-        // returning 1 adds the event to SDL's event queue
-        // returning 0 drops the event so it will not be
-        // processed again in ie. Platform::Impl::processEvents
-        static int handlePriorityAppEvents(void* userdata, SDL_Event* event);
-
-        // ============================================================= //
-        // ============================================================= //
+                m_gl_loaded = false;
 
-        class PlatformSDL : public IPlatform
-        {
-            friend int handlePriorityAppEvents(void *userdata, SDL_Event *event);
+                // The fences belonged to the lost context
+                clearFrameFences(false);
+            }
 
-        public:
-            PlatformSDL(shared_ptr<EventLoop> event_loop) :
-                m_event_loop(event_loop),
-                m_loaded_gl_funcs(false)
+            void PlatformWindowSDL::SetRelativeMotionScale(float scale)
             {
-                g_app_event_loop = event_loop;
-
-                // Init sdl
-                if(SDL_Init(SDL_INIT_VIDEO) < 0) {
-                    std::string error_msg(SDL_GetError());
-                    throw PlatformInitFailed("Unable to initialize SDL: "+error_msg);
-                }
+                m_relative_motion_scale = scale;
+            }
 
-#ifdef KS_ENV_ANDROID
-                if(!SDL_SetHint(SDL_HINT_ANDROID_SEPARATE_MOUSE_AND_TOUCH,"1")) {
-                    std::string error_msg(SDL_GetError());
-                    throw PlatformInitFailed("SDL: Could not set mouse/touch hint: "+error_msg);
+            void PlatformWindowSDL::SetRelativeMotionHistoryEnabled(bool enabled)
+            {
+                m_relative_motion_history_enabled = enabled;
+                if(!enabled) {
+                    m_list_relative_motion_samples.clear();
+                    m_list_relative_motion_history.clear();
                 }
-#endif
-
-                // Enumerate display screens
-                enumerateScreens();
+            }
 
-                // Install event filter for priority app events
-                SDL_SetEventFilter(handlePriorityAppEvents,this);
+            std::vector<RelativeMotionSample> const &
+            PlatformWindowSDL::GetRelativeMotionHistory() const
+            {
+                return m_list_relative_motion_history;
             }
 
-            ~PlatformSDL()
+            void PlatformWindowSDL::SetResizeSettleDelay(Milliseconds delay)
             {
-#ifdef KS_ENV_ANDROID
-                g_signal_screen_rotation_changed.Disconnect(
-                            m_cid_display_rotation);
-#endif
+                m_resize_settle_delay = delay;
             }
 
-            shared_ptr<EventLoop> GetEventLoop()
+            bool PlatformWindowSDL::GetResizing() const
             {
-                return m_event_loop;
+                return m_resizing;
             }
 
-            void ProcessEvents()
+            void PlatformWindowSDL::SetThrottlePolicy(ThrottlePolicy policy,
+                                                      uint cap_hz,
+                                                      bool throttle_unfocused)
             {
-                this->processEvents();
+                if(policy == ThrottlePolicy::CapRate && cap_hz == 0) {
+                    throw WindowSettingFailed(
+                                "SDL: Throttle rate must be greater than zero");
+                }
+
+                m_throttle_cap_hz = cap_hz;
+                m_throttle_unfocused = throttle_unfocused;
+                m_throttle_policy = policy;
             }
 
-            void Run()
+            bool PlatformWindowSDL::GetShown() const
             {
-                LOG.Trace() << "PlatformSDL::Run";
-                m_event_loop->Run();
-                LOG.Trace() << "PlatformSDL::Run returned";
+                return m_shown;
             }
 
-            void Quit()
+            bool PlatformWindowSDL::GetMinimized() const
             {
-                LOG.Trace() << "PlatformSDL::Quit";
+                return m_minimized;
+            }
 
-                // Immediately stop all system event processing
-                m_event_loop->PostStopEvent();
+            bool PlatformWindowSDL::GetFocused() const
+            {
+                return m_focused;
             }
 
-            std::vector<shared_ptr<Screen const>> GetScreens()
+            bool PlatformWindowSDL::GetThrottled() const
             {
-                std::vector<shared_ptr<Screen const>> list_screens;
-                for(auto& screen : m_list_screens) {
-                    list_screens.push_back(screen);
+                if(m_throttle_policy == ThrottlePolicy::None) {
+                    return false;
                 }
 
-                return list_screens;
+                return (!m_shown || m_minimized ||
+                        (m_throttle_unfocused && !m_focused));
             }
 
-            shared_ptr<IPlatformWindow>
-            CreateWindow(shared_ptr<EventLoop>& window_evl,
-                         Window::Attributes& win_attrs,
-                         Window::Properties& win_props)
+            bool PlatformWindowSDL::ShouldRenderFrame()
             {
-#ifdef KS_ENV_ANDROID
-                // We need to ensure that any thread that may call
-                // into JNI is setup properly. As far as we know, any
-                // SDL function may call a JNI function in the SDLActivity
-                // so every thread that calls any SDL function should
-                // first call Android_JNI_SetupThread()
-
-                // We need to call this *from* the thread itself so
-                // we post a task to the Window's event loop
-                window_evl->PostTask(
-                            make_shared<Task>(
-                                [](){
-                                    Android_JNI_SetupThread();
-                                }));
-#else
-                (void)window_evl;
-#endif
+                // Always consume a pending expose so it doesn't
+                // trigger a stale render once throttling starts
+                bool const exposed = m_expose_pending.exchange(false);
+
+                if(!GetThrottled()) {
+                    auto const now = std::chrono::high_resolution_clock::now();
+                    if(!consumeRedraw(exposed,now)) {
+                        return false;
+                    }
 
-                // Request that GL functions be loaded if required
-                bool load_gl_fns = !m_loaded_gl_funcs;
+                    m_last_render_time = now;
+                    return true;
+                }
 
-                m_list_windows.push_back(
-                            make_shared<PlatformWindowSDL>(
-                                win_attrs,
-                                win_props,
-                                load_gl_fns));
+                switch(m_throttle_policy.load())
+                {
+                    case ThrottlePolicy::Pause:
+                    {
+                        return false;
+                    }
+                    case ThrottlePolicy::CapRate:
+                    {
+                        auto const now = std::chrono::high_resolution_clock::now();
+                        auto const interval =
+                                std::chrono::duration_cast<Microseconds>(
+                                    std::chrono::seconds(1))/m_throttle_cap_hz.load();
+
+                        if(now-m_last_render_time < interval ||
+                           !consumeRedraw(exposed,now)) {
+                            return false;
+                        }
 
-                if(!m_loaded_gl_funcs) {
-                    m_loaded_gl_funcs = true;
+                        m_last_render_time = now;
+                        return true;
+                    }
+                    case ThrottlePolicy::ExposeOnly:
+                    {
+                        if(exposed) {
+                            m_last_render_time = std::chrono::high_resolution_clock::now();
+                        }
+                        return exposed;
+                    }
+                    default:
+                    {
+                        return true;
+                    }
                 }
+            }
 
-                return m_list_windows.back();
+            void PlatformWindowSDL::SetRedrawOnDemand(bool enabled)
+            {
+                m_redraw_on_demand = enabled;
+                Invalidate();
             }
 
-            void DestroyWindow(shared_ptr<IPlatformWindow> rem_window)
+            void PlatformWindowSDL::Invalidate()
             {
-                auto it =
-                        std::find_if(
-                            m_list_windows.begin(),
-                            m_list_windows.end(),
-                            [rem_window](shared_ptr<PlatformWindowSDL> const &window) {
-                                return (window == rem_window);
-                            });
+                bool const was_pending = GetRedrawPending();
+                m_invalid = true;
 
-                if(it != m_list_windows.end()) {
-                    (*it)->Destroy();
-                    m_list_windows.erase(it);
+                if(!was_pending) {
+                    signal_redraw_requested.Emit();
                 }
             }
 
-        private:
-            void enumerateScreens()
+            void PlatformWindowSDL::Animate(Milliseconds duration)
             {
-#ifdef KS_ENV_ANDROID
-                // We assume jniOnInitDisplayInfo has been called
-                // before PlatformSDL is created
-
-                // Currently we only support the single in-built
-                // device screen for Android
-
-                m_list_screens.push_back(
-                            make_shared<Screen>(
-                                g_display_name,
-                                g_display_rotation_cw,
-                                g_display_width_px,
-                                g_display_height_px,
-                                g_display_xdpi,
-                                g_display_ydpi));
+                bool const was_pending = GetRedrawPending();
 
-                // Listen for Display rotation changes
-                m_cid_display_rotation =
-                        g_signal_screen_rotation_changed.Connect(
-                            this,&PlatformSDL::onDisplayRotationChanged);
+                s64 const until =
+                        (std::chrono::high_resolution_clock::now()+duration).
+                        time_since_epoch().count();
 
-#else
-                int screen_count = SDL_GetNumVideoDisplays();
-                if(screen_count <= 0) {
-                    std::string const err_msg(SDL_GetError());
-                    throw PlatformInitFailed(
-                                "SDL: Failed to get num displays: "+err_msg);
+                // Only ever extend the active period
+                s64 prev_until = m_animate_until.load();
+                while(prev_until < until &&
+                      !m_animate_until.compare_exchange_weak(prev_until,until)) {
+                    // retry with the updated prev_until
                 }
 
-                for(int i=0; i < screen_count; i++) {
-                    // name
-                    const char* name = SDL_GetDisplayName(i);
-                    if(name==nullptr) {
-                        std::string const err_msg(SDL_GetError());
-                        throw PlatformInitFailed("SDL: Failed to query displays: "+err_msg);
-                    }
-
-                    // dimensions
-                    SDL_Rect size_px_rect;
-                    if(SDL_GetDisplayBounds(i,&size_px_rect) < 0) {
-                        std::string const err_msg(SDL_GetError());
-                        throw PlatformInitFailed("SDL: Failed to query displays: "+err_msg);
-                    }
-
-                    // dpi
-                    float ddpi,hdpi,vdpi;
-                    if(SDL_GetDisplayDPI(i,&ddpi,&hdpi,&vdpi) < 0) {
-                        std::string const err_msg(SDL_GetError());
-                        throw PlatformInitFailed("SDL: Failed to query displays: "+err_msg);
-                    }
-
-                    // rotation
-                    // We just assume a default rotation of 0 degrees
-                    // as there's no API to query in SDL yet
-
-                    m_list_screens.push_back(
-                                make_shared<Screen>(
-                                    std::string(name),
-                                    Screen::Rotation::CW_0,
-                                    size_px_rect.w,
-                                    size_px_rect.h,
-                                    hdpi,
-                                    vdpi));
+                if(!was_pending) {
+                    signal_redraw_requested.Emit();
                 }
-#endif
             }
 
-            void onDisplayRotationChanged(Screen::Rotation rotation)
+            bool PlatformWindowSDL::GetRedrawPending() const
             {
-                m_list_screens[0]->rotation.Set(rotation);
+                return (m_invalid || m_expose_pending ||
+                        getAnimating(std::chrono::high_resolution_clock::now()));
             }
 
-            void processEvents()
+            bool PlatformWindowSDL::getAnimating(TimePoint const &now) const
             {
-                auto const ks_ev_proc_time =
-                        std::chrono::high_resolution_clock::now();
+                return (now.time_since_epoch().count() < m_animate_until.load());
+            }
 
-                Uint32 const sdl_ev_proc_time = SDL_GetTicks();
+            bool PlatformWindowSDL::consumeRedraw(bool exposed, TimePoint const &now)
+            {
+                // Clear the invalid flag even when redraw on demand
+                // is disabled so enabling it later doesn't trigger
+                // a stale redraw
+                bool const invalid = m_invalid.exchange(false);
 
-                // Get all available sdl events
-                SDL_Event sdl_event;
-                std::vector<SDL_Event> list_sdl_events;
-                while(SDL_PollEvent(&sdl_event) != 0) {
-                    list_sdl_events.push_back(sdl_event);
+                if(!m_redraw_on_demand) {
+                    return true;
                 }
 
-                // Process SDL events
-                uint const event_count = list_sdl_events.size();
+                return (invalid || exposed || getAnimating(now));
+            }
+
+            void PlatformWindowSDL::EnableResolutionScaling(ResolutionScaler::Settings const &settings)
+            {
+                requireGLFeatures("Resolution scaling",true,false);
+
+                if(m_present) {
+                    throw WindowSettingFailed(
+                                "Resolution scaling can't be used with "
+                                "the present thread");
+                }
+
+                int width,height;
+                SDL_GL_GetDrawableSize(m_window,&width,&height);
+                m_scaler.reset(new ResolutionScaler(settings,width,height));
+                m_resolution_scale = m_scaler->GetScale();
+            }
+
+            void PlatformWindowSDL::DisableResolutionScaling()
+            {
+                m_scaler.reset();
+                m_resolution_scale = 1.0f;
+            }
+
+            GLuint PlatformWindowSDL::GetRenderFramebuffer() const
+            {
+                if(m_present) {
+                    return m_present->GetFramebuffer();
+                }
+                return (m_scaler ? m_scaler->GetFramebuffer() : 0);
+            }
+
+            Window::Size PlatformWindowSDL::GetRenderSize() const
+            {
+                if(m_present) {
+                    return m_present->GetRenderSize();
+                }
+                if(m_scaler) {
+                    return Window::Size(m_scaler->GetRenderWidth(),
+                                        m_scaler->GetRenderHeight());
+                }
+
+                int width,height;
+                SDL_GL_GetDrawableSize(m_window,&width,&height);
+                return Window::Size(width,height);
+            }
+
+            float PlatformWindowSDL::GetResolutionScale() const
+            {
+                return m_resolution_scale;
+            }
+
+            void PlatformWindowSDL::StartCapture(shared_ptr<FrameCaptureSink> sink,
+                                                 uint ring_size)
+            {
+                requireGLFeatures("Capture",true,true);
+
+                if(m_present) {
+                    throw WindowSettingFailed(
+                                "Capture can't be used with the present thread");
+                }
+
+                m_capture.reset(new FrameCapture(sink,
+                                                 ring_size,
+                                                 m_capture_thread_qos));
+            }
+
+            void PlatformWindowSDL::StopCapture()
+            {
+                m_capture.reset();
+            }
+
+            FrameCapture::Stats PlatformWindowSDL::GetCaptureStats() const
+            {
+                if(!m_capture) {
+                    return FrameCapture::Stats{0,0};
+                }
+                return m_capture->GetStats();
+            }
+
+            void PlatformWindowSDL::SetCaptureThreadQoS(ThreadQoS const &qos)
+            {
+                m_capture_thread_qos = qos;
+            }
+
+            ThreadQoS::Result PlatformWindowSDL::GetCaptureThreadQoSResult() const
+            {
+                if(!m_capture) {
+                    return ThreadQoS::Result();
+                }
+                return m_capture->GetQoSResult();
+            }
+
+            void PlatformWindowSDL::StartPresentThread(uint ring_size)
+            {
+                requireGLFeatures("The present thread",true,true);
+
+                if(m_capture || m_scaler) {
+                    throw WindowSettingFailed(
+                                "The present thread can't be used with "
+                                "capture or resolution scaling");
+                }
+
+                m_present.reset(new PresentThreadSDL(m_window,
+                                                     m_context,
+                                                     ring_size,
+                                                     m_present_thread_qos));
+                m_context = m_present->GetRenderContext();
+                m_context_window = m_present->GetRenderWindow();
+            }
+
+            void PlatformWindowSDL::StopPresentThread()
+            {
+                if(!m_present) {
+                    return;
+                }
+
+                // Makes the window's context current again
+                SDL_GLContext const window_context = m_present->GetWindowContext();
+                m_present.reset();
+                m_context = window_context;
+                m_context_window = m_window;
+            }
+
+            PresentThreadSDL::Stats PlatformWindowSDL::GetPresentStats() const
+            {
+                if(!m_present) {
+                    return PresentThreadSDL::Stats{0,0,0};
+                }
+                return m_present->GetStats();
+            }
+
+            void PlatformWindowSDL::SetPresentThreadQoS(ThreadQoS const &qos)
+            {
+                m_present_thread_qos = qos;
+            }
+
+            ThreadQoS::Result PlatformWindowSDL::GetPresentThreadQoSResult() const
+            {
+                if(!m_present) {
+                    return ThreadQoS::Result();
+                }
+                return m_present->GetQoSResult();
+            }
+
+            void PlatformWindowSDL::SetMaxFramesInFlight(uint max_frames)
+            {
+                bool const has_fences =
+                        std::any_of(m_list_frame_fences.begin(),
+                                    m_list_frame_fences.end(),
+                                    [](GLsync fence) { return (fence != nullptr); });
+
+                if(max_frames > 0) {
+                    requireGLFeatures("Limiting frames in flight",false,true);
+                }
+                else if(has_fences) {
+                    // The fences can only be deleted with the
+                    // context they were created in current
+                    makeContextCurrent();
+                }
+
+                clearFrameFences(true);
+                m_max_frames_in_flight = std::min(max_frames,uint(m_list_frame_fences.size()));
+
+                m_frames_in_flight_stats = FramesInFlightStats();
+                m_frames_in_flight_stats_buffer.Publish(m_frames_in_flight_stats);
+            }
+
+            uint PlatformWindowSDL::GetMaxFramesInFlight() const
+            {
+                return m_max_frames_in_flight;
+            }
+
+            PlatformWindowSDL::FramesInFlightStats
+            PlatformWindowSDL::GetFramesInFlightStats() const
+            {
+                return m_frames_in_flight_stats_buffer.Read();
+            }
+
+            void PlatformWindowSDL::EnableVblankEstimation()
+            {
+                VblankEstimator::Settings settings;
+
+                SDL_DisplayMode mode;
+                if(SDL_GetWindowDisplayMode(m_window,&mode) == 0 &&
+                   mode.refresh_rate > 0) {
+                    settings.nominal_period = Microseconds(1000000/mode.refresh_rate);
+                }
+
+                EnableVblankEstimation(settings);
+            }
+
+            void PlatformWindowSDL::EnableVblankEstimation(VblankEstimator::Settings const &settings)
+            {
+                m_vblank_estimator.reset(new VblankEstimator(settings));
+            }
+
+            void PlatformWindowSDL::DisableVblankEstimation()
+            {
+                m_vblank_estimator.reset();
+            }
+
+            void PlatformWindowSDL::SetSwapTimestampSource(std::function<TimePoint()> source)
+            {
+                m_swap_timestamp_source = std::move(source);
+            }
+
+            VblankEstimator::Estimate PlatformWindowSDL::GetVblankEstimate() const
+            {
+                if(!m_vblank_estimator) {
+                    return VblankEstimator::Estimate();
+                }
+                return m_vblank_estimator->GetEstimate();
+            }
+
+            TimePoint PlatformWindowSDL::GetPredictedPresent() const
+            {
+                return GetPredictedPresent(std::chrono::high_resolution_clock::now());
+            }
+
+            TimePoint PlatformWindowSDL::GetPredictedPresent(TimePoint const &now) const
+            {
+                if(!m_vblank_estimator) {
+                    return now;
+                }
+                return m_vblank_estimator->GetNextVblank(now);
+            }
+
+            void PlatformWindowSDL::addSwapTimestamp()
+            {
+                m_vblank_estimator->AddSample(
+                            m_swap_timestamp_source ?
+                                m_swap_timestamp_source() :
+                                std::chrono::high_resolution_clock::now());
+            }
+
+            void PlatformWindowSDL::limitFramesInFlight()
+            {
+                // The slot holds the fence placed max_frames swaps ago
+                GLsync& fence = m_list_frame_fences[m_frame_fence_index];
+                GLsync const prev_fence = fence;
+
+                fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE,0);
+                m_frame_fence_index = (m_frame_fence_index+1)%m_max_frames_in_flight;
+
+                Microseconds wait(0);
+                if(prev_fence) {
+                    auto const wait_start = std::chrono::high_resolution_clock::now();
+
+                    // Flush on the first wait so the new fence (and
+                    // everything before it) is guaranteed to be
+                    // submitted; the old fence already was
+                    GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+                    for(;;) {
+                        GLenum const result =
+                                glClientWaitSync(prev_fence,flags,1000000000);
+
+                        if(result == GL_ALREADY_SIGNALED ||
+                           result == GL_CONDITION_SATISFIED) {
+                            break;
+                        }
+                        if(result == GL_WAIT_FAILED) {
+                            LOG.Warn() << "PlatformWindowSDL: Waiting on "
+                                          "frame fence failed";
+                            break;
+                        }
+                        flags = 0;
+                    }
+                    glDeleteSync(prev_fence);
+
+                    wait = std::chrono::duration_cast<Microseconds>(
+                                std::chrono::high_resolution_clock::now()-wait_start);
+                }
+
+                m_frames_in_flight_stats.frames++;
+                m_frames_in_flight_stats.wait = wait;
+                m_frames_in_flight_stats.wait_max =
+                        std::max(m_frames_in_flight_stats.wait_max,wait);
+                m_frames_in_flight_stats.wait_total += wait;
+                m_frames_in_flight_stats_buffer.Publish(m_frames_in_flight_stats);
+            }
+
+            void PlatformWindowSDL::clearFrameFences(bool delete_fences)
+            {
+                for(auto& fence : m_list_frame_fences) {
+                    if(fence && delete_fences) {
+                        glDeleteSync(fence);
+                    }
+                    fence = nullptr;
+                }
+                m_frame_fence_index = 0;
+            }
+
+            bool PlatformWindowSDL::GetSoftwareRendering() const
+            {
+                return m_software;
+            }
+
+            LatencyProfileResult PlatformWindowSDL::GetLatencyProfileResult() const
+            {
+                return m_latency_result;
+            }
+
+            PlatformWindowSDL::SoftwareFramebuffer
+            PlatformWindowSDL::GetSoftwareFramebuffer()
+            {
+                if(!m_software) {
+                    throw WindowSettingFailed(
+                                "SDL: Software framebuffer requested for "
+                                "an OpenGL window");
+                }
+
+                // SDL keeps the surface until the window is resized,
+                // so this only allocates after a resize
+                SDL_Surface* surface = SDL_GetWindowSurface(m_window);
+                if(surface == nullptr) {
+                    std::string const err_msg(SDL_GetError());
+                    throw WindowSettingFailed(
+                                "SDL: Failed to get window surface: "+err_msg);
+                }
+
+                if(surface != m_surface) {
+                    m_surface = surface;
+                    m_surface_invalid = true;
+                }
+
+                if(m_surface_invalid) {
+                    // The whole surface is copied on the next swap
+                    m_list_dirty_rects.clear();
+                }
+
+                SoftwareFramebuffer fb;
+                fb.pixels = surface->pixels;
+                fb.width = surface->w;
+                fb.height = surface->h;
+                fb.pitch = surface->pitch;
+                fb.format = surface->format->format;
+                fb.invalidated = m_surface_invalid;
+
+                return fb;
+            }
+
+            void PlatformWindowSDL::AddDirtyRect(sint x, sint y, uint width, uint height)
+            {
+                if(m_surface == nullptr || m_surface_invalid) {
+                    return;
+                }
+
+                // Clip to the surface since some drivers copy
+                // the rects as given
+                sint const x0 = std::max(x,0);
+                sint const y0 = std::max(y,0);
+                sint const x1 = std::min(x+sint(width),m_surface->w);
+                sint const y1 = std::min(y+sint(height),m_surface->h);
+                if(x1 <= x0 || y1 <= y0) {
+                    return;
+                }
+
+                SDL_Rect rect;
+                rect.x = x0;
+                rect.y = y0;
+                rect.w = x1-x0;
+                rect.h = y1-y0;
+
+                // Past a point the per rect overhead outweighs the
+                // copying saved, so the rects are merged into one
+                if(m_list_dirty_rects.size() == k_max_dirty_rects) {
+                    SDL_Rect bounds = rect;
+                    for(auto const &dirty : m_list_dirty_rects) {
+                        SDL_UnionRect(&bounds,&dirty,&bounds);
+                    }
+                    m_list_dirty_rects.clear();
+                    rect = bounds;
+                }
+
+                m_list_dirty_rects.push_back(rect);
+            }
+
+            void PlatformWindowSDL::presentSoftware()
+            {
+                if(m_surface == nullptr) {
+                    return;
+                }
+
+                int err = 0;
+                if(m_surface_invalid) {
+                    err = SDL_UpdateWindowSurface(m_window);
+                    m_surface_invalid = false;
+                }
+                else if(!m_list_dirty_rects.empty()) {
+                    err = SDL_UpdateWindowSurfaceRects(
+                                m_window,
+                                m_list_dirty_rects.data(),
+                                m_list_dirty_rects.size());
+                }
+                m_list_dirty_rects.clear();
+
+                if(err != 0) {
+                    // ie. the window was resized after the surface
+                    // was fetched; the next frame is redrawn in full
+                    LOG.Trace() << "SDL: Failed to update window surface: "
+                                << SDL_GetError();
+                    m_surface_invalid = true;
+                }
+            }
+
+            void PlatformWindowSDL::requireContext(char const * feature) const
+            {
+                if(m_software) {
+                    throw WindowSettingFailed(
+                                std::string("SDL: ")+feature+
+                                " requires an OpenGL window");
+                }
+            }
+
+            void PlatformWindowSDL::requireGLFeatures(char const * feature,
+                                                      bool gl3,
+                                                      bool sync)
+            {
+                requireContext(feature);
+
+                // The version is read from the context itself
+                makeContextCurrent();
+                GLFunctionLoaderSDL::Version const version =
+                        GLFunctionLoaderSDL::GetVersion(m_context);
+
+                // GL 3.0 and GLES 3.0 both have framebuffer blits,
+                // sized renderbuffer formats and mapped pixel buffers
+                if(gl3 && version.major < 3) {
+                    throw WindowSettingFailed(
+                                std::string("SDL: ")+feature+
+                                " requires OpenGL 3.0 or OpenGL ES 3.0");
+                }
+
+                // Sync objects are core in GL 3.2 and GLES 3.0
+                bool const has_sync =
+                        version.es ?
+                            (version.major >= 3) :
+                            (version.major > 3 ||
+                             (version.major == 3 && version.minor >= 2) ||
+                             SDL_GL_ExtensionSupported("GL_ARB_sync"));
+
+                if(sync && !has_sync) {
+                    throw WindowSettingFailed(
+                                std::string("SDL: ")+feature+
+                                " requires sync objects (OpenGL 3.2, "
+                                "ARB_sync or OpenGL ES 3.0)");
+                }
+            }
+
+            void PlatformWindowSDL::visibilityEvent(Uint8 sdl_win_event)
+            {
+                switch(sdl_win_event)
+                {
+                    case SDL_WINDOWEVENT_SHOWN:
+                    case SDL_WINDOWEVENT_HIDDEN:
+                    {
+                        bool const shown = (sdl_win_event == SDL_WINDOWEVENT_SHOWN);
+                        if(m_shown.exchange(shown) != shown) {
+                            signal_visible_changed.Emit(shown);
+                            if(shown) {
+                                Invalidate();
+                            }
+                        }
+                        break;
+                    }
+                    case SDL_WINDOWEVENT_MINIMIZED:
+                    {
+                        if(!m_minimized.exchange(true)) {
+                            signal_minimized_changed.Emit(true);
+                        }
+                        break;
+                    }
+                    case SDL_WINDOWEVENT_MAXIMIZED:
+                    case SDL_WINDOWEVENT_RESTORED:
+                    {
+                        if(m_minimized.exchange(false)) {
+                            signal_minimized_changed.Emit(false);
+                        }
+                        Invalidate();
+                        break;
+                    }
+                    case SDL_WINDOWEVENT_EXPOSED:
+                    {
+                        bool const was_pending = GetRedrawPending();
+                        m_expose_pending = true;
+                        signal_exposed.Emit();
+                        if(!was_pending) {
+                            signal_redraw_requested.Emit();
+                        }
+                        break;
+                    }
+                    case SDL_WINDOWEVENT_FOCUS_GAINED:
+                    case SDL_WINDOWEVENT_FOCUS_LOST:
+                    {
+                        bool const focused = (sdl_win_event == SDL_WINDOWEVENT_FOCUS_GAINED);
+                        if(m_focused.exchange(focused) != focused) {
+                            signal_input_focus_changed.Emit(focused);
+                        }
+                        break;
+                    }
+                    default:
+                    {
+                        break;
+                    }
+                }
+            }
+
+            void PlatformWindowSDL::resizeEvent(Window::Size const &size,
+                                                TimePoint const &timestamp)
+            {
+                // SDL has already dropped the window surface
+                m_surface_invalid = true;
+
+                m_pending_size = size;
+                m_last_resize_time = timestamp;
+                m_resizing = true;
+            }
+
+            void PlatformWindowSDL::flushResize(TimePoint const &timestamp)
+            {
+                if(!m_resizing) {
+                    return;
+                }
+
+                if(m_pending_size != m_size) {
+                    m_size = m_pending_size;
+                    signal_size_changed.Emit(m_size);
+                    Invalidate();
+                }
+
+                if(timestamp-m_last_resize_time >= m_resize_settle_delay) {
+                    m_resizing = false;
+                    signal_resize_settled.Emit(m_size);
+                }
+            }
+
+            void PlatformWindowSDL::accumulateRelativeMotion(TimePoint const &timestamp,
+                                                             sint xrel,
+                                                             sint yrel)
+            {
+                float const x = xrel*m_relative_motion_scale;
+                float const y = yrel*m_relative_motion_scale;
+
+                m_relative_motion.timestamp = timestamp;
+                m_relative_motion.x += x;
+                m_relative_motion.y += y;
+                m_relative_motion.samples++;
+
+                if(m_relative_motion_history_enabled) {
+                    m_list_relative_motion_samples.push_back(
+                                RelativeMotionSample{timestamp,x,y});
+                }
+            }
+
+            void PlatformWindowSDL::flushRelativeMotion()
+            {
+                if(m_relative_motion.samples == 0) {
+                    return;
+                }
+
+                // Swap so that both lists keep their capacity
+                // and samples don't cause allocations per pump
+                std::swap(m_list_relative_motion_history,
+                          m_list_relative_motion_samples);
+                m_list_relative_motion_samples.clear();
+
+                RelativeMotion const motion = m_relative_motion;
+                m_relative_motion = RelativeMotion();
+
+                signal_relative_motion.Emit(motion);
+            }
+
+            void PlatformWindowSDL::SetDropLoader(shared_ptr<FileMapLoader> loader)
+            {
+                m_drop_loader = std::move(loader);
+            }
+
+            shared_ptr<FileMapLoader> const & PlatformWindowSDL::GetDropLoader() const
+            {
+                return m_drop_loader;
+            }
+
+            void PlatformWindowSDL::dropEvent(SDL_DropEvent const &sdl_drop_ev)
+            {
+                switch(sdl_drop_ev.type)
+                {
+                    case SDL_DROPFILE:
+                    {
+                        std::string path(sdl_drop_ev.file);
+                        Id const request_id =
+                                m_drop_loader ? m_drop_loader->Load(path) : 0;
+
+                        signal_file_dropped.Emit(std::move(path),request_id);
+                        break;
+                    }
+#if SDL_VERSION_ATLEAST(2,0,5)
+                    case SDL_DROPTEXT:
+                    {
+                        signal_text_dropped.Emit(std::string(sdl_drop_ev.file));
+                        break;
+                    }
+                    case SDL_DROPBEGIN:
+                    {
+                        signal_drop_begin.Emit();
+                        break;
+                    }
+                    case SDL_DROPCOMPLETE:
+                    {
+                        signal_drop_complete.Emit();
+                        break;
+                    }
+#endif
+                    default:
+                    {
+                        break;
+                    }
+                }
+            }
+
+        // ============================================================= //
+        // ============================================================= //
+
+        namespace
+        {
+            // We need to access this for handleAppPriorityEvents
+            shared_ptr<EventLoop> g_app_event_loop;
+
+            // SDL_MAX_QUEUED_EVENTS in SDL_events.c; SDL silently
+            // drops events once this many are queued
+            uint const k_sdl_max_queued_events = 65535;
+        }
+
+        // returning 1 adds the event to SDL's event queue
+        // returning 0 drops the event so it will not be
+        // processed again in ie. Platform::Impl::processEvents
+        int handlePriorityAppEvents(void* userdata, SDL_Event* event);
+
+        // ============================================================= //
+        // ============================================================= //
+
+            PlatformSDL::PlatformSDL(shared_ptr<EventLoop> event_loop) :
+                m_event_loop(event_loop),
+                m_thread_qos_task_state(make_shared<ThreadQoSTaskState>())
+            {
+                g_app_event_loop = event_loop;
+                m_thread_qos_task_state->platform = this;
+
+                // Init sdl
+                if(SDL_Init(SDL_INIT_VIDEO) < 0) {
+                    std::string error_msg(SDL_GetError());
+                    throw PlatformInitFailed("Unable to initialize SDL: "+error_msg);
+                }
+
+#ifdef KS_ENV_ANDROID
+                if(!SDL_SetHint(SDL_HINT_ANDROID_SEPARATE_MOUSE_AND_TOUCH,"1")) {
+                    std::string error_msg(SDL_GetError());
+                    throw PlatformInitFailed("SDL: Could not set mouse/touch hint: "+error_msg);
+                }
+#endif
+
+                // Enumerate display screens
+                enumerateScreens();
+
+                // Gestures are recognized from the touch tracker so
+                // SDL doesn't need to queue its own gesture events
+                SDL_EventState(SDL_MULTIGESTURE,SDL_IGNORE);
+
+                m_wake_event_type = SDL_RegisterEvents(1);
+
+                // Install event filter for priority app events
+                SDL_SetEventFilter(handlePriorityAppEvents,this);
+            }
+
+            PlatformSDL::~PlatformSDL()
+            {
+                {
+                    // Waits for a task that's emitting
+                    std::lock_guard<std::mutex> lock(m_thread_qos_task_state->mutex);
+                    m_thread_qos_task_state->platform = nullptr;
+                }
+
+#ifdef KS_ENV_ANDROID
+                g_signal_screen_rotation_changed.Disconnect(
+                            m_cid_display_rotation);
+#endif
+                if(m_cursor_id != 0) {
+                    SDL_SetCursor(SDL_GetDefaultCursor());
+                }
+                for(auto& id_cursor : m_list_cursors) {
+                    SDL_FreeCursor(id_cursor.second.sdl_cursor);
+                }
+            }
+
+            shared_ptr<EventLoop> PlatformSDL::GetEventLoop()
+            {
+                return m_event_loop;
+            }
+
+            void PlatformSDL::Run()
+            {
+                LOG.Trace() << "PlatformSDL::Run";
+                m_event_loop->Run();
+                LOG.Trace() << "PlatformSDL::Run returned";
+            }
+
+            void PlatformSDL::Quit()
+            {
+                LOG.Trace() << "PlatformSDL::Quit";
+
+                // Immediately stop all system event processing
+                m_event_loop->PostStopEvent();
+            }
+
+            std::vector<shared_ptr<Screen const>> PlatformSDL::GetScreens()
+            {
+                std::vector<shared_ptr<Screen const>> list_screens;
+                for(auto& screen : m_list_screens) {
+                    list_screens.push_back(screen);
+                }
+
+                return list_screens;
+            }
+
+            shared_ptr<IPlatformWindow>
+            PlatformSDL::CreateWindow(shared_ptr<EventLoop>& window_evl,
+                                      Window::Attributes& win_attrs,
+                                      Window::Properties& win_props)
+            {
+                return createWindow(window_evl,win_attrs,win_props,false);
+            }
+
+            shared_ptr<PlatformWindowSDL>
+            PlatformSDL::CreateSoftwareWindow(shared_ptr<EventLoop>& window_evl,
+                                              Window::Attributes& win_attrs,
+                                              Window::Properties& win_props)
+            {
+                return createWindow(window_evl,win_attrs,win_props,true);
+            }
+
+            void PlatformSDL::SetWindowLatencyProfile(LatencyProfile profile)
+            {
+                m_window_latency_profile = profile;
+            }
+
+            LatencyProfile PlatformSDL::GetWindowLatencyProfile() const
+            {
+                return m_window_latency_profile;
+            }
+
+            shared_ptr<PlatformWindowSDL>
+            PlatformSDL::createWindow(shared_ptr<EventLoop>& window_evl,
+                                      Window::Attributes& win_attrs,
+                                      Window::Properties& win_props,
+                                      bool software)
+            {
+#ifdef KS_ENV_ANDROID
+                // We need to ensure that any thread that may call
+                // into JNI is setup properly. As far as we know, any
+                // SDL function may call a JNI function in the SDLActivity
+                // so every thread that calls any SDL function should
+                // first call Android_JNI_SetupThread()
+
+                // We need to call this *from* the thread itself so
+                // we post a task to the Window's event loop
+                window_evl->PostTask(
+                            make_shared<Task>(
+                                [](){
+                                    Android_JNI_SetupThread();
+                                }));
+#else
+                (void)window_evl;
+#endif
+
+                m_list_windows.push_back(
+                            make_shared<PlatformWindowSDL>(
+                                win_attrs,
+                                win_props,
+                                software,
+                                m_window_latency_profile));
+
+                return m_list_windows.back();
+            }
+
+            void PlatformSDL::DestroyWindow(shared_ptr<IPlatformWindow> rem_window)
+            {
+                auto it =
+                        std::find_if(
+                            m_list_windows.begin(),
+                            m_list_windows.end(),
+                            [rem_window](shared_ptr<PlatformWindowSDL> const &window) {
+                                return (window == rem_window);
+                            });
+
+                if(it != m_list_windows.end()) {
+                    (*it)->Destroy();
+                    m_list_windows.erase(it);
+                }
+            }
+
+            shared_ptr<GameControllerInputSDL> PlatformSDL::GetGameControllerInput()
+            {
+                if(!m_game_controller_input) {
+                    m_game_controller_input =
+                            make_shared<GameControllerInputSDL>(m_event_loop);
+                }
+
+                return m_game_controller_input;
+            }
+
+            void PlatformSDL::SetRelativeMouseMode(bool enabled)
+            {
+                SDL_bool const sdl_enabled = enabled ? SDL_TRUE : SDL_FALSE;
+                if(SDL_SetRelativeMouseMode(sdl_enabled) != 0) {
+                    std::string const err_msg(SDL_GetError());
+                    throw WindowSettingFailed(
+                                "SDL: Failed to set relative mouse mode: "+err_msg);
+                }
+
+                m_relative_mouse_mode = enabled;
+                applyInputEventMask();
+            }
+
+            bool PlatformSDL::GetRelativeMouseMode() const
+            {
+                return m_relative_mouse_mode;
+            }
+
+            TouchTrackerSDL::Snapshot const & PlatformSDL::GetTouchSnapshot() const
+            {
+                return m_touch_tracker.GetSnapshot();
+            }
+
+            GestureRecognizerSDL& PlatformSDL::GetGestureRecognizer()
+            {
+                return m_gesture_recognizer;
+            }
+
+            InputState PlatformSDL::GetInputState() const
+            {
+                return m_input_state_buffer.Read();
+            }
+
+            void PlatformSDL::WaitEvents(Milliseconds max_wait)
+            {
+                // Passing nullptr leaves the event in the queue
+                // for processEvents
+                // Deferred and injected events are dispatched
+                // without waiting
+                bool const injected_pending =
+                        m_injected_events && !m_injected_events->GetEmpty();
+
+                if(m_list_deferred_events.empty() && !injected_pending) {
+                    SDL_WaitEventTimeout(nullptr,static_cast<int>(max_wait.count()));
+                }
+                this->processEvents();
+            }
+
+            void PlatformSDL::WakeEvents()
+            {
+                if(m_wake_event_type == static_cast<Uint32>(-1)) {
+                    // Couldn't register an event type; WaitEvents
+                    // will return after max_wait instead
+                    return;
+                }
+
+                SDL_Event sdl_event;
+                SDL_zero(sdl_event);
+                sdl_event.type = m_wake_event_type;
+                SDL_PushEvent(&sdl_event);
+            }
+
+            EventQueueMetrics PlatformSDL::GetEventQueueMetrics() const
+            {
+                return m_event_metrics_buffer.Read();
+            }
+
+            void PlatformSDL::ResetEventQueueMetrics()
+            {
+                m_event_metrics = EventQueueMetrics();
+                m_event_metrics.pump = m_frame;
+                m_event_metrics_buffer.Publish(m_event_metrics);
+                m_event_backlog = false;
+            }
+
+            void PlatformSDL::SetEventQueueThresholds(EventQueueMetrics::Thresholds const &thresholds)
+            {
+                m_event_thresholds = thresholds;
+            }
+
+            void PlatformSDL::SetEventDispatchBudget(Microseconds budget)
+            {
+                m_event_dispatch_budget = budget;
+            }
+
+            Microseconds PlatformSDL::GetEventDispatchBudget() const
+            {
+                return m_event_dispatch_budget;
+            }
+
+            void PlatformSDL::SetEventLoopThreadQoS(shared_ptr<EventLoop> const &event_loop,
+                                                    ThreadQoS const &qos)
+            {
+                weak_ptr<ThreadQoSTaskState> weak_state = m_thread_qos_task_state;
+
+                event_loop->PostTask(
+                            make_shared<Task>(
+                                [weak_state,qos](){
+                                    ThreadQoS::Result const result = ThreadQoS::Apply(qos);
+                                    if(result.ok) {
+                                        return;
+                                    }
+
+                                    auto state = weak_state.lock();
+                                    if(!state) {
+                                        return;
+                                    }
+
+                                    std::lock_guard<std::mutex> lock(state->mutex);
+                                    if(state->platform) {
+                                        state->platform->signal_thread_qos_failed.Emit(result.error);
+                                    }
+                                }));
+            }
+
+            void PlatformSDL::SetInputInjection(bool enabled, uint capacity)
+            {
+                if(enabled) {
+                    m_injected_events.reset(new MPSCQueue<InjectedEvent>(capacity));
+                    m_list_injected_events.reserve(m_injected_events->GetCapacity());
+                }
+                else {
+                    m_injected_events.reset();
+                    m_list_injected_events.clear();
+                    m_list_injected_events.shrink_to_fit();
+                }
+            }
+
+            bool PlatformSDL::InjectKeyEvent(KeyEvent const &event, TimePoint const &timestamp)
+            {
+                InjectedEvent injected;
+                injected.type = InjectedEvent::Type::Key;
+                injected.timestamp = timestamp;
+                injected.key = event;
+                return injectEvent(injected);
+            }
+
+            bool PlatformSDL::InjectMouseEvent(MouseEvent const &event, TimePoint const &timestamp)
+            {
+                InjectedEvent injected;
+                injected.type = InjectedEvent::Type::Mouse;
+                injected.timestamp = timestamp;
+                injected.mouse = event;
+                return injectEvent(injected);
+            }
+
+            bool PlatformSDL::InjectTouchEvent(TouchEvent const &event, TimePoint const &timestamp)
+            {
+                InjectedEvent injected;
+                injected.type = InjectedEvent::Type::Touch;
+                injected.timestamp = timestamp;
+                injected.touch = event;
+                return injectEvent(injected);
+            }
+
+            bool PlatformSDL::InjectScrollEvent(ScrollEvent const &event, TimePoint const &timestamp)
+            {
+                InjectedEvent injected;
+                injected.type = InjectedEvent::Type::Scroll;
+                injected.timestamp = timestamp;
+                injected.scroll = event;
+                return injectEvent(injected);
+            }
+
+            bool PlatformSDL::injectEvent(InjectedEvent const &event)
+            {
+                if(m_injected_events && m_injected_events->Push(event)) {
+                    return true;
+                }
+
+                m_injected_dropped.fetch_add(1,std::memory_order_relaxed);
+                return false;
+            }
+
+            void PlatformSDL::dispatchInjectedEvent(InjectedEvent const &event, PumpState &pump)
+            {
+                pump.injected++;
+
+                switch(event.type)
+                {
+                    case InjectedEvent::Type::Key:
+                    {
+                        m_input_state.SetKeyDown(
+                                    event.key.scancode,
+                                    event.key.action != KeyEvent::Action::Release);
+                        m_input_state.mods = event.key.mods;
+
+                        signal_keyboard_input.Emit(event.key);
+                        break;
+                    }
+                    case InjectedEvent::Type::Mouse:
+                    {
+                        u32 button = 0;
+                        if(event.mouse.button == MouseEvent::Button::Left) {
+                            button = InputState::POINTER_LEFT;
+                        }
+                        else if(event.mouse.button == MouseEvent::Button::Right) {
+                            button = InputState::POINTER_RIGHT;
+                        }
+                        else if(event.mouse.button == MouseEvent::Button::Middle) {
+                            button = InputState::POINTER_MIDDLE;
+                        }
+
+                        auto& pointer = m_input_state.pointer;
+                        if(event.mouse.action == MouseEvent::Action::Press) {
+                            pointer.buttons |= button;
+                        }
+                        else if(event.mouse.action == MouseEvent::Action::Release) {
+                            pointer.buttons &= ~button;
+                        }
+                        pointer.x = event.mouse.x;
+                        pointer.y = event.mouse.y;
+
+                        signal_mouse_input.Emit(event.mouse);
+                        break;
+                    }
+                    case InjectedEvent::Type::Touch:
+                    {
+                        signal_touch_input.Emit(event.touch);
+                        break;
+                    }
+                    case InjectedEvent::Type::Scroll:
+                    {
+                        signal_scroll_input.Emit(event.scroll);
+                        break;
+                    }
+                }
+            }
+
+            Id PlatformSDL::CreateCursor(std::vector<u8> const &rgba,
+                                         uint width,
+                                         uint height,
+                                         sint hot_x,
+                                         sint hot_y)
+            {
+                if(width == 0 || height == 0 || rgba.size() != width*height*4) {
+                    throw WindowSettingFailed(
+                                "SDL: Cursor image size doesn't match "
+                                "its dimensions");
+                }
+
+                // FNV-1a over the hotspot and image; the image
+                // size follows from the dimensions which are
+                // compared on a hit
+                u64 hash = 14695981039346656037ull;
+                auto const add_to_hash = [&hash](u8 byte) {
+                    hash = (hash ^ byte)*1099511628211ull;
+                };
+
+                for(sint const value : {hot_x,hot_y}) {
+                    for(uint i=0; i < sizeof(value); i++) {
+                        add_to_hash(u8(value >> (i*8)));
+                    }
+                }
+                for(u8 const byte : rgba) {
+                    add_to_hash(byte);
+                }
+
+                // The full compare only runs for cursors with
+                // the same hash
+                auto const range = m_list_cursor_ids_by_hash.equal_range(hash);
+                for(auto it = range.first; it != range.second; ++it) {
+                    Cursor& cursor = m_list_cursors.at(it->second);
+                    if(cursor.width == width &&
+                       cursor.height == height &&
+                       cursor.hot_x == hot_x &&
+                       cursor.hot_y == hot_y &&
+                       cursor.rgba == rgba) {
+                        cursor.refs++;
+                        return it->second;
+                    }
+                }
+
+                // SDL copies the image when creating the cursor, so the
+                // surface can wrap the caller's pixels and be freed
+                // straight after
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+                Uint32 const rmask = 0xFF000000;
+                Uint32 const gmask = 0x00FF0000;
+                Uint32 const bmask = 0x0000FF00;
+                Uint32 const amask = 0x000000FF;
+#else
+                Uint32 const rmask = 0x000000FF;
+                Uint32 const gmask = 0x0000FF00;
+                Uint32 const bmask = 0x00FF0000;
+                Uint32 const amask = 0xFF000000;
+#endif
+                SDL_Surface* surface =
+                        SDL_CreateRGBSurfaceFrom(
+                            const_cast<u8*>(rgba.data()),
+                            width,height,32,width*4,
+                            rmask,gmask,bmask,amask);
+
+                if(surface == nullptr) {
+                    std::string const err_msg(SDL_GetError());
+                    throw WindowSettingFailed(
+                                "SDL: Failed to create cursor surface: "+err_msg);
+                }
+
+                SDL_Cursor* sdl_cursor = SDL_CreateColorCursor(surface,hot_x,hot_y);
+                SDL_FreeSurface(surface);
+
+                if(sdl_cursor == nullptr) {
+                    std::string const err_msg(SDL_GetError());
+                    throw WindowSettingFailed(
+                                "SDL: Failed to create cursor: "+err_msg);
+                }
+
+                Id const cursor_id = m_next_cursor_id++;
+                m_list_cursors.emplace(
+                            cursor_id,
+                            Cursor{sdl_cursor,1,hash,width,height,hot_x,hot_y,rgba});
+                m_list_cursor_ids_by_hash.emplace(hash,cursor_id);
+
+                return cursor_id;
+            }
+
+            void PlatformSDL::DestroyCursor(Id cursor_id)
+            {
+                auto it = m_list_cursors.find(cursor_id);
+                if(it == m_list_cursors.end()) {
+                    LOG.Warn() << "PlatformSDL: DestroyCursor: "
+                                  "Invalid cursor id: " << cursor_id;
+                    return;
+                }
+
+                it->second.refs--;
+                if(it->second.refs > 0) {
+                    return;
+                }
+
+                if(m_cursor_id == cursor_id) {
+                    SetCursor(0);
+                }
+
+                auto const range =
+                        m_list_cursor_ids_by_hash.equal_range(it->second.hash);
+                for(auto hash_it = range.first; hash_it != range.second; ++hash_it) {
+                    if(hash_it->second == cursor_id) {
+                        m_list_cursor_ids_by_hash.erase(hash_it);
+                        break;
+                    }
+                }
+
+                SDL_FreeCursor(it->second.sdl_cursor);
+                m_list_cursors.erase(it);
+            }
+
+            void PlatformSDL::SetCursor(Id cursor_id)
+            {
+                if(cursor_id == m_cursor_id) {
+                    return;
+                }
+
+                if(cursor_id == 0) {
+                    SDL_SetCursor(SDL_GetDefaultCursor());
+                    m_cursor_id = 0;
+                    return;
+                }
+
+                auto it = m_list_cursors.find(cursor_id);
+                if(it == m_list_cursors.end()) {
+                    LOG.Warn() << "PlatformSDL: SetCursor: "
+                                  "Invalid cursor id: " << cursor_id;
+                    return;
+                }
+
+                SDL_SetCursor(it->second.sdl_cursor);
+                m_cursor_id = cursor_id;
+            }
+
+            Id PlatformSDL::GetCursor() const
+            {
+                return m_cursor_id;
+            }
+
+            void PlatformSDL::SetCursorVisible(bool visible)
+            {
+                SDL_ShowCursor(visible ? SDL_ENABLE : SDL_DISABLE);
+            }
+
+            bool PlatformSDL::GetCursorVisible() const
+            {
+                return (SDL_ShowCursor(SDL_QUERY) == SDL_ENABLE);
+            }
+
+            void PlatformSDL::SetInputEventMasking(bool enabled)
+            {
+                m_input_event_masking = enabled;
+                applyInputEventMask();
+            }
+
+            void PlatformSDL::SubscribeInputEvents(uint input_types)
+            {
+                for(uint i=0; i < m_list_input_subscribers.size(); i++) {
+                    if(input_types & (1u << i)) {
+                        m_list_input_subscribers[i]++;
+                    }
+                }
+                applyInputEventMask();
+            }
+
+            void PlatformSDL::UnsubscribeInputEvents(uint input_types)
+            {
+                for(uint i=0; i < m_list_input_subscribers.size(); i++) {
+                    if((input_types & (1u << i)) &&
+                       m_list_input_subscribers[i] > 0) {
+                        m_list_input_subscribers[i]--;
+                    }
+                }
+                applyInputEventMask();
+            }
+
+            uint PlatformSDL::GetEnabledInputEvents() const
+            {
+                return m_enabled_input_events;
+            }
+
+            void PlatformSDL::enumerateScreens()
+            {
+#ifdef KS_ENV_ANDROID
+                // We assume jniOnInitDisplayInfo has been called
+                // before PlatformSDL is created
+
+                // Currently we only support the single in-built
+                // device screen for Android
+
+                m_list_screens.push_back(
+                            make_shared<Screen>(
+                                g_display_name,
+                                g_display_rotation_cw,
+                                g_display_width_px,
+                                g_display_height_px,
+                                g_display_xdpi,
+                                g_display_ydpi));
+
+                // Listen for Display rotation changes
+                m_cid_display_rotation =
+                        g_signal_screen_rotation_changed.Connect(
+                            this,&PlatformSDL::onDisplayRotationChanged);
+
+#else
+                int screen_count = SDL_GetNumVideoDisplays();
+                if(screen_count <= 0) {
+                    std::string const err_msg(SDL_GetError());
+                    throw PlatformInitFailed(
+                                "SDL: Failed to get num displays: "+err_msg);
+                }
+
+                for(int i=0; i < screen_count; i++) {
+                    // name
+                    const char* name = SDL_GetDisplayName(i);
+                    if(name==nullptr) {
+                        std::string const err_msg(SDL_GetError());
+                        throw PlatformInitFailed("SDL: Failed to query displays: "+err_msg);
+                    }
+
+                    // dimensions
+                    SDL_Rect size_px_rect;
+                    if(SDL_GetDisplayBounds(i,&size_px_rect) < 0) {
+                        std::string const err_msg(SDL_GetError());
+                        throw PlatformInitFailed("SDL: Failed to query displays: "+err_msg);
+                    }
+
+                    // dpi
+                    float ddpi,hdpi,vdpi;
+                    if(SDL_GetDisplayDPI(i,&ddpi,&hdpi,&vdpi) < 0) {
+                        std::string const err_msg(SDL_GetError());
+                        throw PlatformInitFailed("SDL: Failed to query displays: "+err_msg);
+                    }
+
+                    // rotation
+                    // We just assume a default rotation of 0 degrees
+                    // as there's no API to query in SDL yet
+
+                    m_list_screens.push_back(
+                                make_shared<Screen>(
+                                    std::string(name),
+                                    Screen::Rotation::CW_0,
+                                    size_px_rect.w,
+                                    size_px_rect.h,
+                                    hdpi,
+                                    vdpi));
+                }
+#endif
+            }
+
+            void PlatformSDL::onDisplayRotationChanged(Screen::Rotation rotation)
+            {
+                m_list_screens[0]->rotation.Set(rotation);
+            }
+
+            void PlatformSDL::processEvents()
+            {
+                PumpState pump;
+                pump.ks_ev_proc_time = std::chrono::high_resolution_clock::now();
+                pump.sdl_ev_proc_time = SDL_GetTicks();
+
+                // Events deferred by the previous call are older
+                // than any that are still queued
+                std::vector<SDL_Event> list_sdl_events;
+                list_sdl_events.swap(m_list_deferred_events);
+
+                // Get all available sdl events
+                SDL_Event sdl_event;
+                uint const deferred_count = list_sdl_events.size();
+                while(SDL_PollEvent(&sdl_event) != 0) {
+                    list_sdl_events.push_back(sdl_event);
+                }
+
+                uint const event_count = list_sdl_events.size();
+                uint const queued_count = event_count-deferred_count;
+
+                // Take the injected events; at most a queue's worth so
+                // injecting threads can't keep this call from returning
+                m_list_injected_events.clear();
+                if(m_injected_events) {
+                    uint const max_injected = m_injected_events->GetCapacity();
+                    InjectedEvent injected_event;
+                    while(m_list_injected_events.size() < max_injected &&
+                          m_injected_events->Pop(injected_event)) {
+                        m_list_injected_events.push_back(injected_event);
+                    }
+
+                    // Events from different threads can be queued out
+                    // of timestamp order
+                    auto const by_timestamp =
+                            [](InjectedEvent const &a, InjectedEvent const &b) {
+                                return (a.timestamp < b.timestamp);
+                            };
+
+                    if(!std::is_sorted(m_list_injected_events.begin(),
+                                       m_list_injected_events.end(),
+                                       by_timestamp)) {
+                        std::stable_sort(m_list_injected_events.begin(),
+                                         m_list_injected_events.end(),
+                                         by_timestamp);
+                    }
+                }
+
+                // Touch events are converted using the size of the
+                // first window, which is queried once if needed
+                m_touch_tracker.BeginFrame();
+
+                // Process SDL and injected events
+                bool keep_processing = true;
+                auto injected_it = m_list_injected_events.begin();
+                auto const injected_end = m_list_injected_events.end();
+
+                if(m_event_dispatch_budget.count() == 0) {
+                    for(auto &sdl_ev : list_sdl_events) {
+                        TimePoint const timestamp =
+                                ConvertSDLTimestamp(sdl_ev.common.timestamp,
+                                                    pump.sdl_ev_proc_time,
+                                                    pump.ks_ev_proc_time);
+
+                        for(; injected_it != injected_end &&
+                              injected_it->timestamp <= timestamp; ++injected_it) {
+                            dispatchInjectedEvent(*injected_it,pump);
+                        }
+
+                        keep_processing = dispatchEvent(sdl_ev,pump);
+                        if(!keep_processing) {
+                            break;
+                        }
+                    }
+                }
+                else {
+                    for(; injected_it != injected_end; ++injected_it) {
+                        dispatchInjectedEvent(*injected_it,pump);
+                    }
+                    keep_processing = dispatchBudgeted(list_sdl_events,pump);
+                }
+
+                // SDL allocates the strings for drop events and leaves
+                // freeing them to the app; this includes events that
+                // weren't dispatched because of SDL_QUIT
+                for(auto &sdl_ev : list_sdl_events) {
+                    if(sdl_ev.type == SDL_DROPFILE
+#if SDL_VERSION_ATLEAST(2,0,5)
+                       || sdl_ev.type == SDL_DROPTEXT
+#endif
+                       ) {
+                        SDL_free(sdl_ev.drop.file);
+                        sdl_ev.drop.file = nullptr;
+                    }
+                }
+
+                if(keep_processing) {
+                    for(; injected_it != injected_end; ++injected_it) {
+                        dispatchInjectedEvent(*injected_it,pump);
+                    }
+                }
+                else {
+                    m_list_deferred_events.clear();
+                    m_injected_dropped += (injected_end-injected_it);
+                }
+
+                // Merged events live on in the deferred event they
+                // were merged into
+                uint const dropped_count =
+                        event_count-pump.dispatched-pump.merged-
+                        m_list_deferred_events.size();
+
+                if(!m_list_windows.empty())
+                {
+                    if(pump.touch_win_width < 0)
+                    {
+                        SDL_GetWindowSize(m_list_windows[0]->GetSDLWindow(),
+                                          &pump.touch_win_width,
+                                          &pump.touch_win_height);
+                    }
+
+                    m_touch_tracker.EndFrame(pump.touch_win_width,pump.touch_win_height);
+
+                    m_gesture_recognizer.Update(
+                                m_touch_tracker.GetSnapshot(),
+                                pump.ks_ev_proc_time);
+                }
+
+                // Publish the input state for polling threads
+                m_input_state.frame = m_frame;
+                m_input_state.timestamp = pump.ks_ev_proc_time;
+                m_input_state.touches = m_touch_tracker.GetSnapshot();
+                m_input_state_buffer.Publish(m_input_state);
+
+                // Emit coalesced sizes and summed relative
+                // motion once per window
+                for(auto& window : m_list_windows) {
+                    window->flushResize(pump.ks_ev_proc_time);
+                    window->flushRelativeMotion();
+                }
+
+                updateEventQueueMetrics(pump,queued_count,dropped_count);
+
+                m_frame++;
+                signal_processed_events.Emit(bool(event_count > 0 || pump.injected > 0));
+            }
+
+            void PlatformSDL::updateEventQueueMetrics(PumpState const &pump,
+                                                      uint queued_count,
+                                                      uint dropped_count)
+            {
+                EventQueueMetrics& metrics = m_event_metrics;
+
+                metrics.pump = m_frame;
+                metrics.counts = pump.counts;
+                metrics.queue_depth = queued_count;
+                metrics.queue_high_water = std::max(metrics.queue_high_water,queued_count);
+                metrics.deferred = m_list_deferred_events.size();
+                metrics.merged = pump.merged;
+                metrics.total_merged += pump.merged;
+                metrics.total_events += queued_count;
+                metrics.ignored_unknown_window += pump.ignored_unknown_window;
+                metrics.ignored_unhandled += pump.ignored_unhandled;
+                metrics.dropped += dropped_count;
+
+                bool const overflowed = (queued_count >= k_sdl_max_queued_events);
+                if(overflowed) {
+                    metrics.queue_overflows++;
+                }
+
+                metrics.injected = pump.injected;
+                metrics.total_injected += pump.injected;
+                metrics.injected_dropped = m_injected_dropped.load(std::memory_order_relaxed);
+
+                metrics.latency_max = Milliseconds(pump.latency_max_ms);
+                metrics.latency_mean_ms = (pump.dispatched > 0) ?
+                            float(pump.latency_sum_ms)/pump.dispatched : 0.0f;
+
+                m_event_metrics_buffer.Publish(metrics);
+
+                // Only signal on the first pump of a backlog
+                auto const &thresholds = m_event_thresholds;
+                bool const backlog =
+                        (dropped_count > 0) || overflowed ||
+                        (thresholds.queue_depth > 0 &&
+                         queued_count >= thresholds.queue_depth) ||
+                        (thresholds.latency.count() > 0 &&
+                         metrics.latency_max >= thresholds.latency);
+
+                if(backlog && !m_event_backlog) {
+                    signal_event_queue_backlog.Emit(metrics);
+                }
+                m_event_backlog = backlog;
+            }
+
+            bool PlatformSDL::dispatchEvent(SDL_Event const &sdl_ev, PumpState &pump)
+            {
+                pump.dispatched++;
+                pump.counts[EventQueueMetrics::GetCategory(sdl_ev.type)]++;
+
+                // Events can be stamped after sdl_ev_proc_time
+                // since SDL_PollEvent keeps pumping
+                Uint32 const latency_ms =
+                        SDL_TICKS_PASSED(pump.sdl_ev_proc_time,sdl_ev.common.timestamp) ?
+                            pump.sdl_ev_proc_time-sdl_ev.common.timestamp : 0;
+
+                pump.latency_max_ms = std::max(pump.latency_max_ms,latency_ms);
+                pump.latency_sum_ms += latency_ms;
+
+                updateInputState(sdl_ev);
+
                 bool keep_processing = true;
-                for(auto &sdl_ev : list_sdl_events)
+
+                switch(sdl_ev.type)
                 {
-                    switch(sdl_ev.type)
+                    case SDL_QUIT:
                     {
-                        case SDL_QUIT:
+                        LOG.Trace() << "SDL_QUIT";
+                        // TODO call SDL_Quit?
+                        keep_processing = false;
+                        signal_quit.Emit();
+                        break;
+                    }
+                    case SDL_WINDOWEVENT:
+                    {
+                        // Get the window this event is from
+                        auto sdl_win_id = sdl_ev.window.windowID;
+
+                        auto window_it = getWindowFromSDLId(sdl_win_id);
+                        if(window_it == m_list_windows.end())
                         {
-                            LOG.Trace() << "SDL_QUIT";
-                            // TODO call SDL_Quit?
-                            keep_processing = false;
-                            signal_quit.Emit();
+                            // Sometimes we get an event for a window after
+                            // its been destroyed which we ignore
+
+                            // TODO Are SDL windowIds reused? Is it possible
+                            // to get latent window events for closed windows
+                            // and mistake them for newly opened ones?
+
+                            pump.ignored_unknown_window++;
                             break;
                         }
-                        case SDL_WINDOWEVENT:
-                        {
-                            // Get the window this event is from
-                            auto sdl_win_id = sdl_ev.window.windowID;
 
-                            auto window_it = getWindowFromSDLId(sdl_win_id);
-                            if(window_it == m_list_windows.end())
-                            {
-                                // Sometimes we get an event for a window after
-                                // its been destroyed which we ignore
+                        auto window = *window_it;
 
-                                // TODO Are SDL windowIds reused? Is it possible
-                                // to get latent window events for closed windows
-                                // and mistake them for newly opened ones?
+                        switch(sdl_ev.window.event)
+                        {
+                            case SDL_WINDOWEVENT_RESIZED:
+                            case SDL_WINDOWEVENT_SIZE_CHANGED:
+                            {
 
+                                // TODO: This might indicate that the
+                                // orientation of the display has changed;
+                                // need to check!
+
+                                // Coalesced; emitted once after all
+                                // events have been processed
+                                window->resizeEvent(
+                                            Window::Size(
+                                                sdl_ev.window.data1,
+                                                sdl_ev.window.data2),
+                                            pump.ks_ev_proc_time);
                                 break;
                             }
-
-                            auto window = *window_it;
-
-                            switch(sdl_ev.window.event)
+                            case SDL_WINDOWEVENT_CLOSE:
                             {
-                                case SDL_WINDOWEVENT_RESIZED:
-                                {
-
-                                    // TODO: This might indicate that the
-                                    // orientation of the display has changed;
-                                    // need to check!
-
-                                    window->signal_size_changed.Emit(
-                                                Window::Size(
-                                                    sdl_ev.window.data1,
-                                                    sdl_ev.window.data2));
-                                    break;
-                                }
-                                case SDL_WINDOWEVENT_CLOSE:
-                                {
-                                    window->signal_close.Emit();
-                                    break;
-                                }
-
-                                default:
-                                {
-                                    break;
-                                }
+                                window->signal_close.Emit();
+                                break;
+                            }
+                            case SDL_WINDOWEVENT_SHOWN:
+                            case SDL_WINDOWEVENT_HIDDEN:
+                            case SDL_WINDOWEVENT_MINIMIZED:
+                            case SDL_WINDOWEVENT_MAXIMIZED:
+                            case SDL_WINDOWEVENT_RESTORED:
+                            case SDL_WINDOWEVENT_EXPOSED:
+                            case SDL_WINDOWEVENT_FOCUS_GAINED:
+                            case SDL_WINDOWEVENT_FOCUS_LOST:
+                            {
+                                window->visibilityEvent(sdl_ev.window.event);
+                                break;
                             }
 
-                            break;
-                        }
-                        case SDL_APP_DIDENTERFOREGROUND:
-                        {
-                            // Corresponds to:
-                            // iOS: didBecomeActive
-                            // Android: onResume
-                            signal_resume.Emit();
-                            break;
+                            default:
+                            {
+                                pump.ignored_unhandled++;
+                                break;
+                            }
                         }
-                        case SDL_RENDER_DEVICE_RESET:
-                        {
-                            LOG.Trace() << "SDL_RENDER_DEVICE_RESET";
 
-                            // We only assume this occurs on Android where
-                            // the application will have a single window.
-
-                            // Its not clear when in the Android app lifecycle
-                            // this will be called so the best we can do is
-                            // pause ASAP to stop rendering
+                        break;
+                    }
+                    case SDL_APP_DIDENTERFOREGROUND:
+                    {
+                        // Corresponds to:
+                        // iOS: didBecomeActive
+                        // Android: onResume
+                        signal_resume.Emit();
+                        break;
+                    }
+                    case SDL_RENDER_DEVICE_RESET:
+                    {
+                        LOG.Trace() << "SDL_RENDER_DEVICE_RESET";
 
-                            // EDIT: I think a context reset on Android can
-                            // only occur after pause is called TODO confirm
-                            // signal_pause.Emit();
+                        // We only assume this occurs on Android where
+                        // the application will have a single window.
 
-                            // SDL should have created the new context and
-                            // set it current before this event is sent, so
-                            // we just update the sole window's context
+                        // Its not clear when in the Android app lifecycle
+                        // this will be called so the best we can do is
+                        // pause ASAP to stop rendering
 
-                            auto sdl_gl_context = SDL_GL_GetCurrentContext();
-                            if(sdl_gl_context == nullptr) {
-                                std::string const err_msg(SDL_GetError());
-                                throw WindowContextMakeCurrentError(
-                                            "SDL: Failed to get context: "
-                                            "after OpenGL context reset "+ err_msg);
-                            }
+                        // EDIT: I think a context reset on Android can
+                        // only occur after pause is called TODO confirm
+                        // signal_pause.Emit();
 
-                            m_list_windows.at(0)->SetSDLGLContext(
-                                        SDL_GL_GetCurrentContext());
+                        // SDL should have created the new context and
+                        // set it current before this event is sent, so
+                        // we just update the sole window's context
 
-                            signal_graphics_reset.Emit();
-                            break;
+                        auto sdl_gl_context = SDL_GL_GetCurrentContext();
+                        if(sdl_gl_context == nullptr) {
+                            std::string const err_msg(SDL_GetError());
+                            throw WindowContextMakeCurrentError(
+                                        "SDL: Failed to get context: "
+                                        "after OpenGL context reset "+ err_msg);
                         }
-                        case SDL_KEYDOWN:
+
+                        m_list_windows.at(0)->SetSDLGLContext(
+                                    SDL_GL_GetCurrentContext());
+
+                        signal_graphics_reset.Emit();
+                        break;
+                    }
+                    case SDL_KEYDOWN:
+                    {
+                        auto key_event = ConvertSDLKeyEvent(sdl_ev.key);
+
+                        // Debug
+                        if((key_event.mods & KeyEvent::MOD_CTRL) == KeyEvent::MOD_CTRL)
                         {
-                            auto key_event = ConvertSDLKeyEvent(sdl_ev.key);
+                            if(key_event.key == KeyEvent::Key::KEY_P)
+                            {
+                                // Pause
+                                signal_pause.Emit();
 
-                            // Debug
-                            if((key_event.mods & KeyEvent::MOD_CTRL) == KeyEvent::MOD_CTRL)
+                            }
+                            else if(key_event.key == KeyEvent::Key::KEY_R)
                             {
-                                if(key_event.key == KeyEvent::Key::KEY_P)
-                                {
-                                    // Pause
-                                    signal_pause.Emit();
-
-                                }
-                                else if(key_event.key == KeyEvent::Key::KEY_R)
-                                {
-                                    // Resume
-                                    signal_resume.Emit();
-                                }
+                                // Resume
+                                signal_resume.Emit();
                             }
+                        }
 
-                            signal_keyboard_input.Emit(key_event);
+                        signal_keyboard_input.Emit(key_event);
+                        break;
+                    }
+                    case SDL_KEYUP:
+                    {
+                        signal_keyboard_input.Emit(
+                                    ConvertSDLKeyEvent(sdl_ev.key));
+                        break;
+                    }
+                    case SDL_TEXTINPUT:
+                    {
+                        std::string utf8text(sdl_ev.text.text);
+                        signal_utf8_input.Emit(utf8text);
+                        break;
+                    }
+                    case SDL_MOUSEBUTTONDOWN:
+                    {
+                        if(sdl_ev.button.which == SDL_TOUCH_MOUSEID)
+                        {
+                            // Synthesized from touch input which
+                            // we already handle separately
                             break;
                         }
-                        case SDL_KEYUP:
+
+                        signal_mouse_input.Emit(
+                                    ConverSDLMouseButtonEvent(
+                                        sdl_ev.button,
+                                        pump.sdl_ev_proc_time,
+                                        pump.ks_ev_proc_time));
+                        break;
+                    }
+                    case SDL_MOUSEBUTTONUP:
+                    {
+                        if(sdl_ev.button.which == SDL_TOUCH_MOUSEID)
                         {
-                            signal_keyboard_input.Emit(
-                                        ConvertSDLKeyEvent(sdl_ev.key));
+                            // Synthesized from touch input which
+                            // we already handle separately
                             break;
                         }
-                        case SDL_TEXTINPUT:
+
+                        signal_mouse_input.Emit(
+                                    ConverSDLMouseButtonEvent(
+                                        sdl_ev.button,
+                                        pump.sdl_ev_proc_time,
+                                        pump.ks_ev_proc_time));
+                        break;
+                    }
+                    case SDL_MOUSEMOTION:
+                    {
+                        if(sdl_ev.motion.which == SDL_TOUCH_MOUSEID)
                         {
-                            std::string utf8text(sdl_ev.text.text);
-                            signal_utf8_input.Emit(utf8text);
                             break;
                         }
-                        case SDL_MOUSEBUTTONDOWN:
+
+                        if(m_relative_mouse_mode)
                         {
-                            signal_mouse_input.Emit(
-                                        ConverSDLMouseButtonEvent(
-                                            sdl_ev.button,
-                                            sdl_ev_proc_time,
-                                            ks_ev_proc_time));
+                            auto window_it = getWindowFromSDLId(sdl_ev.motion.windowID);
+                            if(window_it != m_list_windows.end())
+                            {
+                                (*window_it)->accumulateRelativeMotion(
+                                            ConvertSDLTimestamp(
+                                                sdl_ev.motion.timestamp,
+                                                pump.sdl_ev_proc_time,
+                                                pump.ks_ev_proc_time),
+                                            sdl_ev.motion.xrel,
+                                            sdl_ev.motion.yrel);
+                            }
+                            else
+                            {
+                                pump.ignored_unknown_window++;
+                            }
                             break;
                         }
-                        case SDL_MOUSEBUTTONUP:
+
+                        signal_mouse_input.Emit(
+                                    ConvertSDLMouseMotionEvent(
+                                        sdl_ev.motion,
+                                        pump.sdl_ev_proc_time,
+                                        pump.ks_ev_proc_time));
+                        break;
+                    }
+                    case SDL_FINGERDOWN:
+                    case SDL_FINGERUP:
+                    case SDL_FINGERMOTION:
+                    {
+                        if(!m_list_windows.empty())
                         {
-                            signal_mouse_input.Emit(
-                                        ConverSDLMouseButtonEvent(
-                                            sdl_ev.button,
-                                            sdl_ev_proc_time,
-                                            ks_ev_proc_time));
-                            break;
+                            sint const slot =
+                                    m_touch_tracker.ProcessEvent(sdl_ev.tfinger);
+
+                            if(slot < 0)
+                            {
+                                break;
+                            }
+
+                            // TODO multiple window support
+                            if(pump.touch_win_width < 0)
+                            {
+                                SDL_GetWindowSize(m_list_windows[0]->GetSDLWindow(),
+                                                  &pump.touch_win_width,
+                                                  &pump.touch_win_height);
+                            }
+
+                            auto e =
+                                    ConvertSDLTouchFingerEvent(
+                                        sdl_ev.tfinger,
+                                        pump.sdl_ev_proc_time,
+                                        pump.ks_ev_proc_time,
+                                        slot,
+                                        pump.touch_win_width,
+                                        pump.touch_win_height);
+
+                            signal_touch_input.Emit(e);
                         }
-                        case SDL_MOUSEMOTION:
+                        break;
+                    }
+                    case SDL_MOUSEWHEEL:
+                    {
+                        if(sdl_ev.wheel.which == SDL_TOUCH_MOUSEID)
                         {
-                            signal_mouse_input.Emit(
-                                        ConvertSDLMouseMotionEvent(
-                                            sdl_ev.motion,
-                                            sdl_ev_proc_time,
-                                            ks_ev_proc_time));
+                            // Synthesized from touch input which
+                            // we already handle separately
                             break;
                         }
-                        case SDL_FINGERDOWN:
+
+                        signal_scroll_input.Emit(
+                                    ConvertSDLScrollEvent(
+                                        sdl_ev.wheel));
+                        break;
+                    }
+                    case SDL_DROPFILE:
+#if SDL_VERSION_ATLEAST(2,0,5)
+                    case SDL_DROPTEXT:
+                    case SDL_DROPBEGIN:
+                    case SDL_DROPCOMPLETE:
+#endif
+                    {
+                        auto window_it = getWindowFromSDLDropEvent(sdl_ev.drop);
+                        if(window_it == m_list_windows.end())
                         {
-                            if(!m_list_windows.empty())
-                            {
-                                // TODO multiple window support
-                                sint w=0;
-                                sint h=0;
-                                SDL_GetWindowSize(m_list_windows[0]->GetSDLWindow(),&w,&h);
-
-                                auto e =
-                                        ConvertSDLTouchFingerEvent(
-                                            sdl_ev.tfinger,
-                                            sdl_ev_proc_time,
-                                            ks_ev_proc_time,
-                                            w,h);
-
-                                signal_touch_input.Emit(e);
-                            }
+                            pump.ignored_unknown_window++;
                             break;
                         }
-                        case SDL_FINGERUP:
+
+                        (*window_it)->dropEvent(sdl_ev.drop);
+                        break;
+                    }
+                    case SDL_CONTROLLERDEVICEADDED:
+                    case SDL_CONTROLLERDEVICEREMOVED:
+                    case SDL_CONTROLLERBUTTONDOWN:
+                    {
+                        if(m_game_controller_input)
                         {
-                            if(!m_list_windows.empty())
-                            {
-                                // TODO multiple window support
-                                sint w=0;
-                                sint h=0;
-                                SDL_GetWindowSize(m_list_windows[0]->GetSDLWindow(),&w,&h);
-
-                                auto e =
-                                        ConvertSDLTouchFingerEvent(
-                                            sdl_ev.tfinger,
-                                            sdl_ev_proc_time,
-                                            ks_ev_proc_time,
-                                            w,h);
-
-                                signal_touch_input.Emit(e);
-                            }
-                            break;
+                            m_game_controller_input->ProcessSDLEvent(sdl_ev);
                         }
-                        case SDL_FINGERMOTION:
+                        else
                         {
-                            if(!m_list_windows.empty())
-                            {
-                                // TODO multiple window support
-                                sint w=0;
-                                sint h=0;
-                                SDL_GetWindowSize(m_list_windows[0]->GetSDLWindow(),&w,&h);
-
-                                auto e =
-                                        ConvertSDLTouchFingerEvent(
-                                            sdl_ev.tfinger,
-                                            sdl_ev_proc_time,
-                                            ks_ev_proc_time,
-                                            w,h);
-
-                                signal_touch_input.Emit(e);
-                            }
-                            break;
+                            pump.ignored_unhandled++;
                         }
-                        case SDL_MOUSEWHEEL:
+                        break;
+                    }
+
+                    default:
+                    {
+                        if(sdl_ev.type != m_wake_event_type)
                         {
-                            signal_scroll_input.Emit(
-                                        ConvertSDLScrollEvent(
-                                            sdl_ev.wheel));
-                            break;
+                            pump.ignored_unhandled++;
+                        }
+                        break;
+                    }
+                }
+
+                return keep_processing;
+            }
+
+            bool PlatformSDL::dispatchBudgeted(std::vector<SDL_Event> const &list_sdl_events,
+                                               PumpState &pump)
+            {
+                // Events that can't be deferred are all dispatched
+                // first regardless of the budget
+                for(auto const &sdl_ev : list_sdl_events) {
+                    if(!getEventDeferrable(sdl_ev)) {
+                        if(!dispatchEvent(sdl_ev,pump)) {
+                            return false;
+                        }
+                    }
+                }
+
+                // The rest are dispatched with whatever is left of
+                // the budget and deferred to the next call after
+                auto const deadline = pump.ks_ev_proc_time+m_event_dispatch_budget;
+
+                for(auto const &sdl_ev : list_sdl_events) {
+                    if(!getEventDeferrable(sdl_ev)) {
+                        continue;
+                    }
+
+                    if(m_list_deferred_events.empty() &&
+                       std::chrono::high_resolution_clock::now() < deadline) {
+                        if(!dispatchEvent(sdl_ev,pump)) {
+                            return false;
                         }
+                    }
+                    else {
+                        deferEvent(sdl_ev,pump);
+                    }
+                }
+
+                return true;
+            }
+
+            void PlatformSDL::deferEvent(SDL_Event const &sdl_ev, PumpState &pump)
+            {
+                // Consecutive mouse motion for the same window and
+                // mouse is merged so a backlog doesn't keep growing
+                if(sdl_ev.type == SDL_MOUSEMOTION && !m_list_deferred_events.empty()) {
+                    SDL_Event &prev = m_list_deferred_events.back();
+                    if(prev.type == SDL_MOUSEMOTION &&
+                       prev.motion.windowID == sdl_ev.motion.windowID &&
+                       prev.motion.which == sdl_ev.motion.which) {
+                        prev.motion.timestamp = sdl_ev.motion.timestamp;
+                        prev.motion.state = sdl_ev.motion.state;
+                        prev.motion.x = sdl_ev.motion.x;
+                        prev.motion.y = sdl_ev.motion.y;
+                        prev.motion.xrel += sdl_ev.motion.xrel;
+                        prev.motion.yrel += sdl_ev.motion.yrel;
+                        pump.merged++;
+                        return;
+                    }
+                }
+
+                m_list_deferred_events.push_back(sdl_ev);
+            }
 
-                        default:
+            bool PlatformSDL::getEventDeferrable(SDL_Event const &sdl_ev)
+            {
+                switch(sdl_ev.type)
+                {
+                    case SDL_MOUSEMOTION:
+                    {
+                        return true;
+                    }
+                    case SDL_WINDOWEVENT:
+                    {
+                        switch(sdl_ev.window.event)
                         {
+                            case SDL_WINDOWEVENT_MOVED:
+                            case SDL_WINDOWEVENT_RESIZED:
+                            case SDL_WINDOWEVENT_SIZE_CHANGED:
+                            case SDL_WINDOWEVENT_EXPOSED:
+                            {
+                                return true;
+                            }
+                            default:
+                            {
+                                return false;
+                            }
+                        }
+                    }
+                    default:
+                    {
+                        return false;
+                    }
+                }
+            }
+
+            void PlatformSDL::applyInputEventMask()
+            {
+                // SDL event types for each InputEventType bit
+                static std::vector<std::vector<Uint32>> const list_sdl_types {
+                    { SDL_KEYDOWN, SDL_KEYUP },
+                    { SDL_TEXTINPUT, SDL_TEXTEDITING },
+                    { SDL_MOUSEBUTTONDOWN, SDL_MOUSEBUTTONUP },
+                    { SDL_MOUSEMOTION },
+                    { SDL_MOUSEWHEEL },
+                    { SDL_FINGERDOWN, SDL_FINGERUP, SDL_FINGERMOTION }
+                };
+
+                uint enabled_input_events = 0;
+                for(uint i=0; i < m_list_input_subscribers.size(); i++) {
+                    uint const input_type = (1u << i);
+
+                    bool const enabled =
+                            !m_input_event_masking ||
+                            m_list_input_subscribers[i] > 0 ||
+                            (input_type == INPUT_MOUSE_MOTION && m_relative_mouse_mode);
+
+                    if(enabled) {
+                        enabled_input_events |= input_type;
+                    }
+
+                    if((m_enabled_input_events & input_type) == (enabled_input_events & input_type)) {
+                        continue;
+                    }
+
+                    // Ignoring a type also flushes any that
+                    // are already queued
+                    for(auto sdl_type : list_sdl_types[i]) {
+                        SDL_EventState(sdl_type,enabled ? SDL_ENABLE : SDL_IGNORE);
+                    }
+                }
+
+                m_enabled_input_events = enabled_input_events;
+            }
+
+            void PlatformSDL::updateInputState(SDL_Event const &sdl_ev)
+            {
+                switch(sdl_ev.type)
+                {
+                    case SDL_KEYDOWN:
+                    case SDL_KEYUP:
+                    {
+                        m_input_state.SetKeyDown(
+                                    sdl_ev.key.keysym.scancode,
+                                    sdl_ev.type == SDL_KEYDOWN);
+
+                        m_input_state.mods =
+                                ConvertSDLKeyMods(sdl_ev.key.keysym.mod);
+                        break;
+                    }
+                    case SDL_MOUSEBUTTONDOWN:
+                    case SDL_MOUSEBUTTONUP:
+                    {
+                        if(sdl_ev.button.which == SDL_TOUCH_MOUSEID) {
                             break;
                         }
+
+                        u32 button = 0;
+                        if(sdl_ev.button.button == SDL_BUTTON_LEFT) {
+                            button = InputState::POINTER_LEFT;
+                        }
+                        else if(sdl_ev.button.button == SDL_BUTTON_RIGHT) {
+                            button = InputState::POINTER_RIGHT;
+                        }
+                        else if(sdl_ev.button.button == SDL_BUTTON_MIDDLE) {
+                            button = InputState::POINTER_MIDDLE;
+                        }
+
+                        auto& pointer = m_input_state.pointer;
+                        if(sdl_ev.type == SDL_MOUSEBUTTONDOWN) {
+                            pointer.buttons |= button;
+                        }
+                        else {
+                            pointer.buttons &= ~button;
+                        }
+
+                        pointer.window_id = sdl_ev.button.windowID;
+                        pointer.x = sdl_ev.button.x;
+                        pointer.y = sdl_ev.button.y;
+                        break;
                     }
+                    case SDL_MOUSEMOTION:
+                    {
+                        if(sdl_ev.motion.which == SDL_TOUCH_MOUSEID) {
+                            break;
+                        }
 
-                    if(!keep_processing)
+                        auto& pointer = m_input_state.pointer;
+                        pointer.window_id = sdl_ev.motion.windowID;
+                        pointer.x = sdl_ev.motion.x;
+                        pointer.y = sdl_ev.motion.y;
+                        break;
+                    }
+                    default:
                     {
                         break;
                     }
                 }
-
-                m_frame++;
-                signal_processed_events.Emit(bool(event_count > 0));
             }
 
             std::vector<shared_ptr<PlatformWindowSDL>>::iterator
-            getWindowFromSDLId(Id sdl_win_id)
+            PlatformSDL::getWindowFromSDLId(Id sdl_win_id)
             {
                 auto it =
                         std::find_if(
@@ -984,25 +2892,24 @@ namespace ks
                 return it;
             }
 
-            shared_ptr<EventLoop> m_event_loop;
-            std::vector<shared_ptr<gui::Screen>> m_list_screens;
-            std::vector<shared_ptr<PlatformWindowSDL>> m_list_windows;
-
-            // * flag to indicate whether or not OpenGL
-            //   functions have been loaded (may not be
-            //   required for certain platforms)
-            // * we only load functions once even across
-            //   multiple contexts; we assume that only
-            //   a single type of context and surface will
-            //   be used across all windows
-            bool m_loaded_gl_funcs;
-
-#ifdef KS_ENV_ANDROID
-            Id m_cid_display_rotation;
+            std::vector<shared_ptr<PlatformWindowSDL>>::iterator
+            PlatformSDL::getWindowFromSDLDropEvent(SDL_DropEvent const &sdl_drop_ev)
+            {
+                // Drops that aren't onto a window (ie. onto the app's
+                // dock icon on macOS) have no window id, as do all
+                // drops before SDL 2.0.5; they go to the first window
+                Id sdl_win_id = 0;
+#if SDL_VERSION_ATLEAST(2,0,5)
+                sdl_win_id = sdl_drop_ev.windowID;
+#else
+                (void)sdl_drop_ev;
 #endif
+                if(sdl_win_id == 0) {
+                    return m_list_windows.begin();
+                }
 
-            u64 m_frame{0};
-        };
+                return getWindowFromSDLId(sdl_win_id);
+            }
 
         // ============================================================= //
         // ============================================================= //
@@ -0,0 +1,961 @@
+/*
+   Copyright (C) 2015-2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef KS_GUI_PLATFORM_SDL_HPP
+#define KS_GUI_PLATFORM_SDL_HPP
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+
+#include <ks/gl/KsGLConfig.hpp>
+
+#include <SDL2/SDL.h>
+
+#include <ks/gui/KsGuiPlatform.hpp>
+#include <ks/platform/KsPlatformOpts.hpp>
+#include <ks/platform/KsPlatformSnapshotBuffer.hpp>
+#include <ks/platform/KsPlatformMPSCQueue.hpp>
+#include <ks/platform/KsPlatformFrameCapture.hpp>
+#include <ks/platform/KsPlatformFileMapLoader.hpp>
+#include <ks/platform/KsPlatformResolutionScaler.hpp>
+#include <ks/platform/KsPlatformVblankEstimator.hpp>
+#include <ks/platform/sdl/KsGuiGameControllerSDL.hpp>
+#include <ks/platform/sdl/KsGuiTouchTrackerSDL.hpp>
+#include <ks/platform/sdl/KsGuiGestureRecognizerSDL.hpp>
+#include <ks/platform/sdl/KsGuiInputStateSDL.hpp>
+#include <ks/platform/sdl/KsGuiEventMetricsSDL.hpp>
+#include <ks/platform/sdl/KsGuiPresentThreadSDL.hpp>
+
+namespace ks
+{
+    namespace gui
+    {
+        // The SDL implementations of IPlatform and IPlatformWindow.
+        // Functionality that has no equivalent in the IPlatform
+        // interfaces can be accessed by casting, ie:
+        // std::static_pointer_cast<PlatformSDL>(platform)
+
+        // ============================================================= //
+        // ============================================================= //
+
+        // Relative pointer motion summed over one ProcessEvents call
+        struct RelativeMotion
+        {
+            // Time of the most recent sample
+            TimePoint timestamp;
+
+            float x{0.0f};
+            float y{0.0f};
+            uint samples{0};
+        };
+
+        // A single relative pointer motion sample
+        struct RelativeMotionSample
+        {
+            TimePoint timestamp;
+            float x;
+            float y;
+        };
+
+        // See PlatformSDL::SetWindowLatencyProfile
+        enum class LatencyProfile
+        {
+            Default,
+            LowLatency
+        };
+
+        // What a window's latency profile actually got from
+        // the window system and driver
+        struct LatencyProfileResult
+        {
+            LatencyProfile profile{LatencyProfile::Default};
+
+            // The window was created on X11 with
+            // _NET_WM_BYPASS_COMPOSITOR requested
+            bool compositor_bypass{false};
+
+            // The window is in exclusive (mode setting) fullscreen
+            // rather than a fullscreen desktop sized window
+            bool exclusive_fullscreen{false};
+
+            // The swap interval in effect; -1 is adaptive vsync
+            sint swap_interval{0};
+        };
+
+        // ============================================================= //
+        // ============================================================= //
+
+        class PlatformWindowSDL KS_PLATFORM_FINAL : public IPlatformWindow
+        {
+            friend class PlatformSDL;
+
+        public:
+            // * With software set the window has no OpenGL context;
+            //   frames are drawn into its cpu framebuffer instead
+            //   (see GetSoftwareFramebuffer)
+            PlatformWindowSDL(Window::Attributes& attrs,
+                              Window::Properties& props,
+                              bool software=false,
+                              LatencyProfile profile=LatencyProfile::Default);
+
+            ~PlatformWindowSDL();
+
+            bool IsCurrentContext();
+            void MakeContextCurrent();
+            void ReleaseContext();
+            void SwapBuffers();
+            void SetSize(Window::Size const &size);
+            void SetPosition(Window::Position const &position);
+            void SetFullscreen(Window::FullscreenMode fullscreen);
+            void SetFocused(bool);
+            void SetVisible(bool visible);
+            void SetAlwaysOnTop(bool);
+            void SetSwapInterval(uint swap_interval);
+            void SetTitle(std::string const &title);
+            void Destroy();
+
+            SDL_Window* GetSDLWindow();
+            void SetSDLGLContext(SDL_GLContext context);
+
+            // * Returns which parts of the latency profile the window
+            //   was created with took effect (see
+            //   PlatformSDL::SetWindowLatencyProfile)
+            // * Updated by SetFullscreen; must be called from the
+            //   thread that creates and configures the window
+            LatencyProfileResult GetLatencyProfileResult() const;
+
+            // * Scale applied to relative motion before it's
+            //   accumulated (defaults to 1)
+            void SetRelativeMotionScale(float scale);
+
+            // * If enabled, the individual samples that made up
+            //   the most recent signal_relative_motion can be
+            //   retrieved with GetRelativeMotionHistory
+            // * The history is replaced on every ProcessEvents that
+            //   had motion, so it's kept through pumps without any
+            void SetRelativeMotionHistoryEnabled(bool enabled);
+            std::vector<RelativeMotionSample> const &
+            GetRelativeMotionHistory() const;
+
+            // * SDL size events are coalesced so that
+            //   signal_size_changed is emitted at most once
+            //   per ProcessEvents with the latest size
+            // * signal_resize_settled is emitted once no size
+            //   events have arrived for the settle delay (zero
+            //   by default), so expensive work like reallocating
+            //   framebuffers can wait until a drag ends
+            void SetResizeSettleDelay(Milliseconds delay);
+            bool GetResizing() const;
+            Signal<Window::Size> signal_resize_settled;
+
+            // * How rendering should be throttled while the window
+            //   is hidden or minimized, and optionally while it
+            //   doesn't have input focus (ie. behind other windows)
+            // * Pause: never render
+            // * CapRate: render at most cap_hz times a second
+            // * ExposeOnly: only render when the window system
+            //   reports that the window contents were damaged
+            enum class ThrottlePolicy
+            {
+                None,
+                Pause,
+                CapRate,
+                ExposeOnly
+            };
+
+            void SetThrottlePolicy(ThrottlePolicy policy,
+                                   uint cap_hz=0,
+                                   bool throttle_unfocused=false);
+
+            // Tracked from SDL window events; safe to call
+            // from any thread
+            bool GetShown() const;
+            bool GetMinimized() const;
+            bool GetFocused() const;
+            bool GetThrottled() const;
+
+            // * Returns whether the frame loop should render and
+            //   swap a frame now according to the throttle policy
+            // * Meant to be called once per frame from the thread
+            //   that renders this window; a true result counts as
+            //   a rendered frame
+            bool ShouldRenderFrame();
+
+            // * If redraw on demand is enabled, ShouldRenderFrame
+            //   only returns true while the window is invalid or
+            //   animating, so an idle window doesn't render or swap
+            // * Invalidate marks the window as needing one redraw;
+            //   Animate keeps it redrawing every frame until the
+            //   given duration from now has passed (overlapping
+            //   calls extend the period)
+            // * Resizes, exposes and restores invalidate the window
+            // * signal_redraw_requested is emitted when the window
+            //   goes from not needing a redraw to needing one, so
+            //   the render thread can be woken by connecting to it
+            //   instead of polling; after rendering a frame, check
+            //   GetRedrawPending to see if another is needed
+            // * Invalidate and Animate are safe to call from any
+            //   thread
+            void SetRedrawOnDemand(bool enabled);
+            void Invalidate();
+            void Animate(Milliseconds duration);
+            bool GetRedrawPending() const;
+            Signal<> signal_redraw_requested;
+
+            // * Starts reading back every swapped frame into sink
+            //   without stalling the render thread (see FrameCapture)
+            // * Start and Stop must be called with this window's
+            //   context current; GetCaptureStats is safe from any
+            //   thread while capturing
+            // * StartCapture throws WindowSettingFailed unless the
+            //   context is OpenGL 3.2 (or 3.0 with ARB_sync) or
+            //   OpenGL ES 3.0, since it needs pixel buffers and
+            //   sync objects
+            void StartCapture(shared_ptr<FrameCaptureSink> sink,
+                              uint ring_size=3);
+            void StopCapture();
+            FrameCapture::Stats GetCaptureStats() const;
+
+            // * Scheduling settings for the capture's copy thread,
+            //   applied when capture is started; the outcome can be
+            //   checked with GetCaptureThreadQoSResult once it's
+            //   running
+            // * A FrameCaptureFileSink's writer thread takes its
+            //   own settings when the sink is created
+            void SetCaptureThreadQoS(ThreadQoS const &qos);
+            ThreadQoS::Result GetCaptureThreadQoSResult() const;
+
+            // * Renders at a resolution scaled by the frame time and
+            //   upscales to the window at SwapBuffers (see
+            //   ResolutionScaler)
+            // * While enabled, apps should bind GetRenderFramebuffer
+            //   wherever they'd bind the default framebuffer and
+            //   size the viewport with GetRenderSize; both can
+            //   change after every SwapBuffers
+            // * Input is unaffected and stays in window coordinates
+            // * Enable and Disable must be called with this window's
+            //   context current; GetResolutionScale is safe from any
+            //   thread and can be used to adjust ie. text sharpness
+            // * EnableResolutionScaling throws WindowSettingFailed
+            //   unless the context is OpenGL 3.0 or OpenGL ES 3.0,
+            //   since it blits between sized renderbuffers
+            void EnableResolutionScaling(ResolutionScaler::Settings const &settings);
+            void DisableResolutionScaling();
+            GLuint GetRenderFramebuffer() const;
+            Window::Size GetRenderSize() const;
+            float GetResolutionScale() const;
+
+            // * Presents frames from a separate thread so that
+            //   SwapBuffers never blocks on vsync (see PresentThreadSDL)
+            // * While running, MakeContextCurrent makes a render
+            //   context shared with the window's context current,
+            //   SwapBuffers hands the frame to the present thread,
+            //   and apps should bind GetRenderFramebuffer wherever
+            //   they'd bind the default framebuffer
+            // * Start and Stop must be called on the render thread
+            //   with this window's context current. Destroying the
+            //   window stops the thread too, and should be done with
+            //   the context free to be made current; if it can't be,
+            //   the thread is still stopped but its GL objects leak
+            // * StartPresentThread throws WindowSettingFailed unless
+            //   the context is OpenGL 3.2 (or 3.0 with ARB_sync) or
+            //   OpenGL ES 3.0, since it blits and waits on sync
+            //   objects
+            // * If the present thread can't make the window's context
+            //   current, the next SwapBuffers stops it and swaps
+            //   directly from then on; that frame is lost and
+            //   GetRenderFramebuffer goes back to 0
+            // * Can't be combined with capture or resolution scaling
+            void StartPresentThread(uint ring_size=3);
+            void StopPresentThread();
+            PresentThreadSDL::Stats GetPresentStats() const;
+
+            // * Scheduling settings for the present thread, applied
+            //   when it's started; the outcome can be checked with
+            //   GetPresentThreadQoSResult once it's running
+            void SetPresentThreadQoS(ThreadQoS const &qos);
+            ThreadQoS::Result GetPresentThreadQoSResult() const;
+
+            // * Limits how many frames the gpu can queue ahead of
+            //   the cpu. After each swap a fence is placed and the
+            //   fence from max_frames frames earlier is waited on,
+            //   so SwapBuffers returns once at most max_frames
+            //   frames are still in flight
+            // * Lower values reduce input latency at the cost of
+            //   throughput; with 1 the cpu never runs more than a
+            //   frame ahead of the gpu
+            // * max_frames is clamped to 3; 0 disables the limit,
+            //   which is the default
+            // * Not applied while the present thread is running
+            // * Must be called with this window's context current;
+            //   GetFramesInFlightStats is safe from any thread
+            // * Throws WindowSettingFailed for a nonzero max_frames
+            //   unless the context has sync objects (OpenGL 3.2,
+            //   ARB_sync or OpenGL ES 3.0)
+            struct FramesInFlightStats
+            {
+                u64 frames{0};
+
+                // Time SwapBuffers spent waiting on fences for the
+                // most recent frame, the longest wait and the total
+                Microseconds wait{0};
+                Microseconds wait_max{0};
+                Microseconds wait_total{0};
+            };
+
+            void SetMaxFramesInFlight(uint max_frames);
+            uint GetMaxFramesInFlight() const;
+            FramesInFlightStats GetFramesInFlightStats() const;
+
+            // * Estimates the display's refresh period and vblank
+            //   phase from the times SwapBuffers returns (see
+            //   VblankEstimator), so animations and frame pacing can
+            //   target the next refresh
+            // * Without settings the nominal period is taken from
+            //   the refresh rate of the window's display mode when
+            //   SDL reports one
+            // * Only useful with vsync on, and not fed while the
+            //   present thread is running
+            // * SetSwapTimestampSource replaces the clock that's read
+            //   after each swap, ie. to drive the estimator with
+            //   simulated timings on SDL's dummy or offscreen video
+            //   drivers; an empty function restores the default
+            // * Enable, Disable and SetSwapTimestampSource must be
+            //   called from the render thread; GetVblankEstimate and
+            //   GetPredictedPresent are safe from any thread while
+            //   estimation is enabled
+            void EnableVblankEstimation();
+            void EnableVblankEstimation(VblankEstimator::Settings const &settings);
+            void DisableVblankEstimation();
+            void SetSwapTimestampSource(std::function<TimePoint()> source);
+            VblankEstimator::Estimate GetVblankEstimate() const;
+
+            // * Returns the predicted time of the next vblank after
+            //   now, or now if there is no estimate
+            // * The first overload reads now from the system clock;
+            //   with a swap timestamp source, pass the current time
+            //   on that source's timeline instead
+            TimePoint GetPredictedPresent() const;
+            TimePoint GetPredictedPresent(TimePoint const &now) const;
+
+            // * Software windows expose the window's cpu framebuffer
+            //   from SDL_GetWindowSurface for drawing directly into;
+            //   SwapBuffers copies only the regions passed to
+            //   AddDirtyRect since the last swap to the screen
+            // * The framebuffer is replaced when the window is
+            //   resized, so it should be fetched every frame. When
+            //   SoftwareFramebuffer::invalidated is set its contents
+            //   are undefined; the whole frame should be redrawn and
+            //   the next swap copies all of it
+            // * The GL functions (MakeContextCurrent, capture,
+            //   resolution scaling etc) are unavailable and throw
+            //   WindowSettingFailed where they'd create gl objects
+            // * SDL's window surface functions must be called from
+            //   the thread that processes events, so software windows
+            //   must be drawn and swapped from that thread
+            struct SoftwareFramebuffer
+            {
+                void* pixels{nullptr};
+                uint width{0};
+                uint height{0};
+                uint pitch{0};
+                Uint32 format{SDL_PIXELFORMAT_UNKNOWN};
+                bool invalidated{false};
+            };
+
+            bool GetSoftwareRendering() const;
+            SoftwareFramebuffer GetSoftwareFramebuffer();
+            void AddDirtyRect(sint x, sint y, uint width, uint height);
+
+            Signal<bool> signal_minimized_changed;
+            Signal<bool> signal_input_focus_changed;
+            Signal<> signal_exposed;
+
+            // * Emitted at most once per ProcessEvents while
+            //   the platform is in relative mouse mode, with
+            //   all motion over this window summed
+            Signal<RelativeMotion> signal_relative_motion;
+
+            // * With a loader set, each file dropped onto this window
+            //   is also passed to loader->Load and the request id is
+            //   emitted with signal_file_dropped; the loader's signals
+            //   report the mapped file
+            // * Set an empty pointer to stop loading dropped files
+            void SetDropLoader(shared_ptr<FileMapLoader> loader);
+            shared_ptr<FileMapLoader> const & GetDropLoader() const;
+
+            // * Emitted when files or text are dragged onto this
+            //   window and dropped
+            // * A drop of several files emits signal_drop_begin, then
+            //   signal_file_dropped once per file, then
+            //   signal_drop_complete
+            // * The strings are copies; SDL's are freed after the
+            //   events are processed
+            Signal<> signal_drop_begin;
+            Signal<> signal_drop_complete;
+
+            // (path, loader request id or 0 without a loader)
+            Signal<std::string,Id> signal_file_dropped;
+            Signal<std::string> signal_text_dropped;
+
+        private:
+            void makeContextCurrent();
+            void captureFrame();
+            void presentScaled();
+            void stopFailedPresentThread();
+            void limitFramesInFlight();
+            void addSwapTimestamp();
+            void presentSoftware();
+            void requireContext(char const * feature) const;
+            void requireGLFeatures(char const * feature, bool gl3, bool sync);
+            void clearFrameFences(bool delete_fences);
+            void accumulateRelativeMotion(TimePoint const &timestamp,
+                                          sint xrel,
+                                          sint yrel);
+            void flushRelativeMotion();
+            void resizeEvent(Window::Size const &size,
+                             TimePoint const &timestamp);
+            void flushResize(TimePoint const &timestamp);
+            void visibilityEvent(Uint8 sdl_win_event);
+            void dropEvent(SDL_DropEvent const &sdl_drop_ev);
+            bool getAnimating(TimePoint const &now) const;
+            bool consumeRedraw(bool exposed, TimePoint const &now);
+
+            SDL_Window* m_window;
+            SDL_GLContext m_context;
+
+            // The window m_context is made current with; differs
+            // from m_window while the present thread is running
+            SDL_Window* m_context_window;
+
+            // Whether GL functions have been loaded for m_context
+            // (see GLFunctionLoaderSDL)
+            bool m_gl_loaded{false};
+
+            float m_relative_motion_scale{1.0f};
+            bool m_relative_motion_history_enabled{false};
+            RelativeMotion m_relative_motion;
+            std::vector<RelativeMotionSample> m_list_relative_motion_samples;
+            std::vector<RelativeMotionSample> m_list_relative_motion_history;
+
+            Window::Size m_size;
+            Window::Size m_pending_size;
+            bool m_resizing{false};
+            TimePoint m_last_resize_time;
+            Milliseconds m_resize_settle_delay{0};
+
+            std::atomic<bool> m_shown{false};
+            std::atomic<bool> m_minimized{false};
+            std::atomic<bool> m_focused{false};
+            std::atomic<bool> m_expose_pending{false};
+
+            std::atomic<ThrottlePolicy> m_throttle_policy{ThrottlePolicy::None};
+            std::atomic<uint> m_throttle_cap_hz{0};
+            std::atomic<bool> m_throttle_unfocused{false};
+            TimePoint m_last_render_time;
+
+            std::atomic<bool> m_redraw_on_demand{false};
+            std::atomic<bool> m_invalid{true};
+
+            // high_resolution_clock ticks since its epoch
+            std::atomic<s64> m_animate_until{0};
+
+            unique_ptr<FrameCapture> m_capture;
+            ThreadQoS m_capture_thread_qos;
+
+            unique_ptr<ResolutionScaler> m_scaler;
+            std::atomic<float> m_resolution_scale{1.0f};
+
+            unique_ptr<PresentThreadSDL> m_present;
+            ThreadQoS m_present_thread_qos;
+
+            uint m_max_frames_in_flight{0};
+            uint m_frame_fence_index{0};
+            std::array<GLsync,3> m_list_frame_fences{};
+            FramesInFlightStats m_frames_in_flight_stats;
+            SnapshotBuffer<FramesInFlightStats> m_frames_in_flight_stats_buffer;
+
+            unique_ptr<VblankEstimator> m_vblank_estimator;
+            std::function<TimePoint()> m_swap_timestamp_source;
+
+            bool m_software{false};
+            SDL_Surface* m_surface{nullptr};
+            bool m_surface_invalid{true};
+            std::vector<SDL_Rect> m_list_dirty_rects;
+
+            shared_ptr<FileMapLoader> m_drop_loader;
+
+            LatencyProfileResult m_latency_result;
+        };
+
+        // ============================================================= //
+        // ============================================================= //
+
+        class PlatformSDL KS_PLATFORM_FINAL : public IPlatform
+        {
+            friend int handlePriorityAppEvents(void *userdata, SDL_Event *event);
+
+        public:
+            PlatformSDL(shared_ptr<EventLoop> event_loop);
+            ~PlatformSDL();
+
+            shared_ptr<EventLoop> GetEventLoop();
+            void ProcessEvents();
+            void Run();
+            void Quit();
+
+            std::vector<shared_ptr<Screen const>> GetScreens();
+
+            shared_ptr<IPlatformWindow>
+            CreateWindow(shared_ptr<EventLoop>& window_evl,
+                         Window::Attributes& win_attrs,
+                         Window::Properties& win_props);
+
+            void DestroyWindow(shared_ptr<IPlatformWindow> rem_window);
+
+            // * Creates a window without an OpenGL context that's
+            //   drawn through its cpu framebuffer, for systems
+            //   without a gpu (see PlatformWindowSDL::SoftwareFramebuffer)
+            // * Destroyed with DestroyWindow
+            shared_ptr<PlatformWindowSDL>
+            CreateSoftwareWindow(shared_ptr<EventLoop>& window_evl,
+                                 Window::Attributes& win_attrs,
+                                 Window::Properties& win_props);
+
+            // * Sets the latency profile for windows created after
+            //   the call, including through CreateWindow
+            // * LowLatency trades tearing and power for fewer frames
+            //   between rendering and the display:
+            //   - On X11 the window asks the compositor to stop
+            //     compositing it (SDL_HINT_VIDEO_X11_NET_WM_BYPASS_COMPOSITOR)
+            //     which most compositors honor for fullscreen windows
+            //   - Desktop fullscreen is replaced with exclusive
+            //     fullscreen, falling back to desktop fullscreen if
+            //     the mode can't be set; windowed windows stay windowed
+            //   - With vsync requested (a nonzero swap interval),
+            //     adaptive vsync is used where the driver supports it,
+            //     otherwise the requested interval; a swap interval of
+            //     zero is kept as is
+            // * Each of these can be refused by the system; what took
+            //   effect is reported by the window's
+            //   GetLatencyProfileResult and logged
+            // * Limiting the window's frames in flight to one
+            //   (PlatformWindowSDL::SetMaxFramesInFlight) removes
+            //   latency the driver adds by queueing frames
+            void SetWindowLatencyProfile(LatencyProfile profile);
+            LatencyProfile GetWindowLatencyProfile() const;
+
+            // * Returns the game controller input subsystem
+            // * SDL's game controller subsystem is initialized
+            //   on the first call so apps that don't use
+            //   controllers don't pay for it
+            // * Must be called from the app event loop thread
+            shared_ptr<GameControllerInputSDL> GetGameControllerInput();
+
+            // * In relative mouse mode the cursor is hidden and
+            //   motion isn't limited by the window edges
+            // * Motion events are not emitted through
+            //   signal_mouse_input in this mode; they're summed
+            //   per window and emitted once per ProcessEvents
+            //   through PlatformWindowSDL::signal_relative_motion
+            void SetRelativeMouseMode(bool enabled);
+            bool GetRelativeMouseMode() const;
+
+            // * Returns all touch contacts as of the end of the
+            //   most recent ProcessEvents. Slot numbers match
+            //   TouchEvent::index
+            // * Must be called from the app event loop thread
+            TouchTrackerSDL::Snapshot const & GetTouchSnapshot() const;
+
+            // * Pan, pinch and rotate gestures are recognized from
+            //   the touch contacts at the end of each ProcessEvents;
+            //   connect to GestureRecognizerSDL::signal_gesture
+            GestureRecognizerSDL& GetGestureRecognizer();
+
+            // * Returns the keyboard, pointer and touch state as of
+            //   the end of the most recent ProcessEvents
+            // * Can be called from any thread and takes no locks; it
+            //   is lock-free rather than wait-free, and only retries
+            //   if several pumps publish while it copies the state
+            //   (see SnapshotBuffer)
+            InputState GetInputState() const;
+
+            // * Blocks until an SDL event is available, WakeEvents
+            //   is called or max_wait passes, then processes events
+            // * Lets an idle app sleep instead of polling; max_wait
+            //   should be no longer than the time until the next
+            //   timer that's due on the calling thread's event loop
+            // * WakeEvents is safe to call from any thread
+            void WaitEvents(Milliseconds max_wait);
+            void WakeEvents();
+
+            // * Metrics for the event queue, updated once per
+            //   ProcessEvents; GetEventQueueMetrics can be called
+            //   from any thread
+            // * signal_event_queue_backlog is emitted from
+            //   ProcessEvents when a pump exceeds a threshold or
+            //   drops events after one that didn't
+            // * Reset and SetThresholds must be called from the
+            //   thread that calls ProcessEvents
+            EventQueueMetrics GetEventQueueMetrics() const;
+            void ResetEventQueueMetrics();
+            void SetEventQueueThresholds(EventQueueMetrics::Thresholds const &thresholds);
+            Signal<EventQueueMetrics> signal_event_queue_backlog;
+
+            // Flags for input event subscriptions
+            enum InputEventType : uint
+            {
+                INPUT_KEYBOARD = 1 << 0,
+                INPUT_TEXT = 1 << 1,
+                INPUT_MOUSE_BUTTON = 1 << 2,
+                INPUT_MOUSE_MOTION = 1 << 3,
+                INPUT_MOUSE_WHEEL = 1 << 4,
+                INPUT_TOUCH = 1 << 5
+            };
+
+            // * With input event masking enabled, SDL is told to
+            //   ignore input event types that have no subscribers
+            //   so they're never queued, converted or emitted
+            // * Masking is disabled by default; every input type
+            //   is delivered regardless of subscriptions
+            // * Anything that connects to one of the input signals,
+            //   polls GetInputState or uses the touch snapshot or
+            //   gesture recognizer should subscribe to the types it
+            //   needs; subscriptions are counted, so each Subscribe
+            //   should be paired with an Unsubscribe
+            // * Mouse motion stays enabled in relative mouse mode
+            // * Must be called from the thread that calls
+            //   ProcessEvents
+            void SetInputEventMasking(bool enabled);
+            void SubscribeInputEvents(uint input_types);
+            void UnsubscribeInputEvents(uint input_types);
+            uint GetEnabledInputEvents() const;
+
+            // * With a non-zero budget, events are dispatched in two
+            //   lanes. Quit, app lifecycle, key, text, button, wheel,
+            //   touch, controller and window state events
+            //   (shown, hidden, focus, close etc) are always
+            //   dispatched first, in the order they arrived
+            // * Mouse motion and window move, resize and expose
+            //   events are then dispatched in arrival order until
+            //   the budget measured from the start of the
+            //   ProcessEvents call runs out; the rest are deferred
+            //   to the next call, with consecutive mouse motion for
+            //   the same window merged
+            // * Touch motion is always in the first lane. Deferred,
+            //   it could be dispatched after the same finger's up
+            //   event, and the touch tracker drops motion for a
+            //   contact that's already been released
+            // * Ordering: events within a lane keep their order,
+            //   including per window, and deferred events are
+            //   dispatched before newer ones of their lane. An event
+            //   in the first lane can overtake earlier motion,
+            //   resize or expose events for the same window, so
+            //   position dependent handlers should use the position
+            //   in the button or touch event itself
+            // * Defaults to zero, which dispatches every event in
+            //   arrival order
+            void SetEventDispatchBudget(Microseconds budget);
+            Microseconds GetEventDispatchBudget() const;
+
+            // * Hardware cursors are composited by the window system,
+            //   so they move at the display's rate regardless of the
+            //   app's frame rate and cost nothing to draw
+            // * CreateCursor takes an RGBA8 image (rows top to bottom,
+            //   width*height*4 bytes) and its hotspot and returns an
+            //   id for the prepared cursor. Cursors are cached by
+            //   image and hotspot; creating one that already exists
+            //   returns the existing id and adds a reference, which
+            //   DestroyCursor releases
+            // * SetCursor only switches SDL's active cursor so it's
+            //   cheap enough to call every frame; id 0 is the
+            //   system's default cursor
+            // * CreateCursor throws WindowSettingFailed if the image
+            //   is the wrong size or SDL can't create the cursor
+            //   (ie. the video driver has no cursor support)
+            // * Must be called from the thread that calls
+            //   ProcessEvents
+            Id CreateCursor(std::vector<u8> const &rgba,
+                            uint width,
+                            uint height,
+                            sint hot_x,
+                            sint hot_y);
+            void DestroyCursor(Id cursor_id);
+            void SetCursor(Id cursor_id);
+            Id GetCursor() const;
+            void SetCursorVisible(bool visible);
+            bool GetCursorVisible() const;
+
+            // * Injects input as if it came from the window system,
+            //   ie. for automation and load tests, without going
+            //   through SDL's locked event queue
+            // * Events are dispatched by ProcessEvents through the
+            //   same input signals as real input, merged with SDL's
+            //   events by timestamp (to SDL's 1ms resolution). Events
+            //   injected from one thread keep their order
+            // * The keyboard and pointer in GetInputState are updated;
+            //   injected touches aren't seen by the touch tracker or
+            //   gesture recognizer
+            // * With a dispatch budget, injected events are dispatched
+            //   ahead of SDL's and aren't deferred
+            // * Injected events are counted separately in the event
+            //   queue metrics so they can be told apart from real
+            //   input
+            // * SetInputInjection must be called from the thread that
+            //   calls ProcessEvents, before any thread injects and
+            //   after they've all stopped. capacity is the most events
+            //   that can be waiting between two ProcessEvents calls
+            // * Inject* can be called from any thread and never block;
+            //   they return false if injection is disabled or the
+            //   queue is full, in which case the event is dropped
+            // * Injecting doesn't wake WaitEvents; call WakeEvents
+            //   after a batch if the app waits for events
+            void SetInputInjection(bool enabled, uint capacity=16384);
+            bool InjectKeyEvent(KeyEvent const &event, TimePoint const &timestamp);
+            bool InjectMouseEvent(MouseEvent const &event, TimePoint const &timestamp);
+            bool InjectTouchEvent(TouchEvent const &event, TimePoint const &timestamp);
+            bool InjectScrollEvent(ScrollEvent const &event, TimePoint const &timestamp);
+
+            // * Applies qos to the thread that runs event_loop, ie. the
+            //   app's or a window's event loop, from a task posted to
+            //   it; it takes effect once the loop runs the task
+            // * Settings that couldn't be applied (ie. for lack of
+            //   permissions) are emitted through
+            //   signal_thread_qos_failed from that thread, unless
+            //   the platform has been destroyed by then
+            // * For threads the platform owns, see
+            //   PlatformWindowSDL::SetPresentThreadQoS and
+            //   SetCaptureThreadQoS; other threads can use
+            //   ThreadQoS::Apply directly
+            // * Can be called from any thread
+            void SetEventLoopThreadQoS(shared_ptr<EventLoop> const &event_loop,
+                                       ThreadQoS const &qos);
+            Signal<std::string> signal_thread_qos_failed;
+
+        private:
+            // State for a single processEvents call
+            struct PumpState
+            {
+                TimePoint ks_ev_proc_time;
+                Uint32 sdl_ev_proc_time;
+
+                sint touch_win_width{-1};
+                sint touch_win_height{-1};
+
+                uint dispatched{0};
+                uint merged{0};
+                uint ignored_unknown_window{0};
+                uint ignored_unhandled{0};
+                std::array<uint,EventQueueMetrics::CategoryCount> counts{};
+                Uint32 latency_max_ms{0};
+                u64 latency_sum_ms{0};
+
+                uint injected{0};
+            };
+
+            struct InjectedEvent
+            {
+                enum class Type : u8
+                {
+                    Key,
+                    Mouse,
+                    Touch,
+                    Scroll
+                };
+
+                Type type;
+                TimePoint timestamp;
+                KeyEvent key;
+                MouseEvent mouse;
+                TouchEvent touch;
+                ScrollEvent scroll;
+            };
+
+            struct Cursor
+            {
+                SDL_Cursor* sdl_cursor;
+                uint refs;
+
+                // Cache key
+                u64 hash;
+                uint width;
+                uint height;
+                sint hot_x;
+                sint hot_y;
+                std::vector<u8> rgba;
+            };
+
+            // Shared with tasks posted by SetEventLoopThreadQoS,
+            // which can run after the platform is destroyed; the
+            // platform is cleared on destruction
+            struct ThreadQoSTaskState
+            {
+                std::mutex mutex;
+                PlatformSDL* platform{nullptr};
+            };
+
+            shared_ptr<PlatformWindowSDL>
+            createWindow(shared_ptr<EventLoop>& window_evl,
+                         Window::Attributes& win_attrs,
+                         Window::Properties& win_props,
+                         bool software);
+
+            void enumerateScreens();
+            void onDisplayRotationChanged(Screen::Rotation rotation);
+            void processEvents();
+            void updateInputState(SDL_Event const &sdl_ev);
+            void applyInputEventMask();
+            void updateEventQueueMetrics(PumpState const &pump,
+                                         uint queued_count,
+                                         uint dropped_count);
+            bool dispatchEvent(SDL_Event const &sdl_ev, PumpState &pump);
+            bool dispatchBudgeted(std::vector<SDL_Event> const &list_sdl_events,
+                                  PumpState &pump);
+            void deferEvent(SDL_Event const &sdl_ev, PumpState &pump);
+            bool injectEvent(InjectedEvent const &event);
+            void dispatchInjectedEvent(InjectedEvent const &event, PumpState &pump);
+            static bool getEventDeferrable(SDL_Event const &sdl_ev);
+
+            std::vector<shared_ptr<PlatformWindowSDL>>::iterator
+            getWindowFromSDLId(Id sdl_win_id);
+
+            std::vector<shared_ptr<PlatformWindowSDL>>::iterator
+            getWindowFromSDLDropEvent(SDL_DropEvent const &sdl_drop_ev);
+
+            shared_ptr<EventLoop> m_event_loop;
+            std::vector<shared_ptr<gui::Screen>> m_list_screens;
+            std::vector<shared_ptr<PlatformWindowSDL>> m_list_windows;
+
+            shared_ptr<GameControllerInputSDL> m_game_controller_input;
+
+            bool m_relative_mouse_mode{false};
+
+            bool m_input_event_masking{false};
+            std::array<uint,6> m_list_input_subscribers{};
+            uint m_enabled_input_events{0x3F}; // all types
+
+            Microseconds m_event_dispatch_budget{0};
+            std::vector<SDL_Event> m_list_deferred_events;
+
+            unique_ptr<MPSCQueue<InjectedEvent>> m_injected_events;
+            std::vector<InjectedEvent> m_list_injected_events;
+            std::atomic<u64> m_injected_dropped{0};
+
+            std::map<Id,Cursor> m_list_cursors;
+
+            // Cursor ids by the hash of their image and hotspot;
+            // a multimap since different cursors can share a hash
+            std::unordered_multimap<u64,Id> m_list_cursor_ids_by_hash;
+            Id m_cursor_id{0};
+            Id m_next_cursor_id{1};
+
+            LatencyProfile m_window_latency_profile{LatencyProfile::Default};
+
+            shared_ptr<ThreadQoSTaskState> m_thread_qos_task_state;
+
+            TouchTrackerSDL m_touch_tracker;
+            GestureRecognizerSDL m_gesture_recognizer;
+
+            // Input state is updated while events are processed
+            // and published once per processEvents
+            InputState m_input_state;
+            SnapshotBuffer<InputState> m_input_state_buffer;
+
+            EventQueueMetrics m_event_metrics;
+            SnapshotBuffer<EventQueueMetrics> m_event_metrics_buffer;
+            EventQueueMetrics::Thresholds m_event_thresholds;
+            bool m_event_backlog{false};
+
+#ifdef KS_ENV_ANDROID
+            Id m_cid_display_rotation;
+#endif
+
+            u64 m_frame{0};
+
+            // SDL user event type pushed by WakeEvents
+            Uint32 m_wake_event_type;
+        };
+
+        // ============================================================= //
+        // ============================================================= //
+
+        // The per-frame calls are defined here so they can be
+        // inlined when called through the concrete types
+
+        inline bool PlatformWindowSDL::IsCurrentContext()
+        {
+            return (SDL_GL_GetCurrentContext() == m_context);
+        }
+
+        inline void PlatformWindowSDL::MakeContextCurrent()
+        {
+            if(SDL_GL_GetCurrentContext() == m_context && m_gl_loaded) {
+                return;
+            }
+
+            makeContextCurrent();
+        }
+
+        inline void PlatformWindowSDL::SwapBuffers()
+        {
+            if(m_software) {
+                presentSoftware();
+                return;
+            }
+
+            if(m_present) {
+                if(m_present->SubmitFrame()) {
+                    return;
+                }
+                stopFailedPresentThread();
+            }
+
+            if(m_scaler) {
+                presentScaled();
+            }
+
+            if(m_capture) {
+                captureFrame();
+            }
+
+            SDL_GL_SwapWindow(m_window);
+
+            if(m_vblank_estimator) {
+                addSwapTimestamp();
+            }
+
+            if(m_max_frames_in_flight > 0) {
+                limitFramesInFlight();
+            }
+
+            if(m_scaler) {
+                m_scaler->FrameStarted();
+            }
+        }
+
+        inline void PlatformSDL::ProcessEvents()
+        {
+            this->processEvents();
+        }
+
+        // ============================================================= //
+        // ============================================================= //
+    }
+}
+
+#endif // KS_GUI_PLATFORM_SDL_HPP
@@ -0,0 +1,375 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <ks/platform/sdl/KsGuiPresentThreadSDL.hpp>
+
+#include <ks/KsLog.hpp>
+#include <ks/platform/sdl/KsGuiGLFunctionLoaderSDL.hpp>
+
+#if defined(KS_ENV_ANDROID)
+extern "C" {
+int Android_JNI_SetupThread();
+}
+#endif
+
+namespace ks
+{
+    namespace gui
+    {
+        PresentThreadSDL::PresentThreadSDL(SDL_Window* window,
+                                           SDL_GLContext window_context,
+                                           uint ring_size,
+                                           ThreadQoS const &qos) :
+            m_window(window),
+            m_window_context(window_context),
+            m_render_window(nullptr),
+            m_render_context(nullptr),
+            m_swap_interval(SDL_GL_GetSwapInterval()),
+            m_qos(qos),
+            m_gl_forgotten(false),
+            m_list_slots(ring_size < 3 ? 3 : ring_size),
+            m_rendering(0),
+            m_stop(false),
+            m_ready(-1),
+            m_failed(false),
+            m_presenting(-1),
+            m_submitted(0),
+            m_presented(0),
+            m_dropped(0)
+        {
+            m_render_window =
+                    SDL_CreateWindow("",0,0,1,1,
+                                     SDL_WINDOW_OPENGL|SDL_WINDOW_HIDDEN);
+
+            if(m_render_window == nullptr) {
+                std::string const err_msg(SDL_GetError());
+                throw WindowSettingFailed(
+                            "SDL: Failed to create render window: "+err_msg);
+            }
+
+            // The new context is made current
+            SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT,1);
+            m_render_context = SDL_GL_CreateContext(m_render_window);
+            SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT,0);
+
+            if(m_render_context == nullptr) {
+                std::string const err_msg(SDL_GetError());
+                SDL_DestroyWindow(m_render_window);
+                throw WindowSettingFailed(
+                            "SDL: Failed to create render context: "+err_msg);
+            }
+
+            int width,height;
+            SDL_GL_GetDrawableSize(m_window,&width,&height);
+
+            for(auto& slot : m_list_slots) {
+                glGenTextures(1,&slot.texture);
+                glGenRenderbuffers(1,&slot.depth_stencil_rb);
+                glGenFramebuffers(1,&slot.fbo);
+
+                resizeSlot(slot,width,height);
+
+                glBindFramebuffer(GL_FRAMEBUFFER,slot.fbo);
+                glFramebufferTexture2D(GL_FRAMEBUFFER,
+                                       GL_COLOR_ATTACHMENT0,
+                                       GL_TEXTURE_2D,
+                                       slot.texture,
+                                       0);
+                glFramebufferRenderbuffer(GL_FRAMEBUFFER,
+                                          GL_DEPTH_STENCIL_ATTACHMENT,
+                                          GL_RENDERBUFFER,
+                                          slot.depth_stencil_rb);
+
+                if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+                    LOG.Warn() << "PresentThreadSDL: Framebuffer is incomplete";
+                }
+            }
+
+            m_list_slots[m_rendering].state = State::Rendering;
+            glBindFramebuffer(GL_FRAMEBUFFER,m_list_slots[m_rendering].fbo);
+
+            // The textures must be complete before the present
+            // context can start reading from them
+            glFinish();
+
+            m_thread = std::thread(&PresentThreadSDL::present,this);
+        }
+
+        PresentThreadSDL::~PresentThreadSDL()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stop = true;
+            }
+            m_cv.notify_one();
+            m_thread.join();
+
+            if(!m_gl_forgotten) {
+                glBindFramebuffer(GL_FRAMEBUFFER,0);
+                for(auto& slot : m_list_slots) {
+                    if(slot.render_fence) {
+                        glDeleteSync(slot.render_fence);
+                    }
+                    if(slot.read_fence) {
+                        glDeleteSync(slot.read_fence);
+                    }
+                    glDeleteFramebuffers(1,&slot.fbo);
+                    glDeleteRenderbuffers(1,&slot.depth_stencil_rb);
+                    glDeleteTextures(1,&slot.texture);
+                }
+            }
+
+            if(SDL_GL_MakeCurrent(m_window,m_window_context) != 0) {
+                LOG.Warn() << "PresentThreadSDL: Failed to restore "
+                              "window context: " << SDL_GetError();
+            }
+
+            GLFunctionLoaderSDL::RemoveContext(m_render_context);
+            SDL_GL_DeleteContext(m_render_context);
+            SDL_DestroyWindow(m_render_window);
+        }
+
+        SDL_GLContext PresentThreadSDL::GetWindowContext() const
+        {
+            return m_window_context;
+        }
+
+        SDL_Window* PresentThreadSDL::GetRenderWindow() const
+        {
+            return m_render_window;
+        }
+
+        SDL_GLContext PresentThreadSDL::GetRenderContext() const
+        {
+            return m_render_context;
+        }
+
+        GLuint PresentThreadSDL::GetFramebuffer() const
+        {
+            return m_list_slots[m_rendering].fbo;
+        }
+
+        Window::Size PresentThreadSDL::GetRenderSize() const
+        {
+            Slot const &slot = m_list_slots[m_rendering];
+            return Window::Size(slot.width,slot.height);
+        }
+
+        bool PresentThreadSDL::SubmitFrame()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if(m_failed) {
+                    return false;
+                }
+            }
+
+            Slot& slot = m_list_slots[m_rendering];
+
+            // The flush ensures the fence reaches the gpu so the
+            // present context's wait on it can complete
+            slot.render_fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE,0);
+            glFlush();
+
+            GLsync dropped_fence = nullptr;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if(m_ready >= 0) {
+                    // Replace the frame that hasn't been
+                    // presented yet
+                    Slot& dropped = m_list_slots[m_ready];
+                    dropped.state = State::Free;
+                    dropped_fence = dropped.render_fence;
+                    dropped.render_fence = nullptr;
+                    m_dropped++;
+                }
+
+                slot.state = State::Ready;
+                m_ready = m_rendering;
+                m_submitted++;
+
+                acquireSlot();
+            }
+            m_cv.notify_one();
+
+            if(dropped_fence) {
+                glDeleteSync(dropped_fence);
+            }
+
+            Slot& next = m_list_slots[m_rendering];
+
+            // Queue a wait on the gpu for the present context to
+            // finish reading from the slot before it's reused
+            if(next.read_fence) {
+                glWaitSync(next.read_fence,0,GL_TIMEOUT_IGNORED);
+                glDeleteSync(next.read_fence);
+                next.read_fence = nullptr;
+            }
+
+            int width,height;
+            SDL_GL_GetDrawableSize(m_window,&width,&height);
+            if(uint(width) != next.width || uint(height) != next.height) {
+                resizeSlot(next,width,height);
+            }
+
+            glBindFramebuffer(GL_FRAMEBUFFER,next.fbo);
+
+            return true;
+        }
+
+        PresentThreadSDL::Stats PresentThreadSDL::GetStats() const
+        {
+            return Stats{m_submitted.load(),
+                         m_presented.load(),
+                         m_dropped.load()};
+        }
+
+        ThreadQoS::Result PresentThreadSDL::GetQoSResult() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_qos_result;
+        }
+
+        void PresentThreadSDL::ForgetGLObjects()
+        {
+            m_gl_forgotten = true;
+        }
+
+        void PresentThreadSDL::resizeSlot(Slot& slot, uint width, uint height)
+        {
+            slot.width = width;
+            slot.height = height;
+
+            glBindTexture(GL_TEXTURE_2D,slot.texture);
+            glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,GL_LINEAR);
+            glTexImage2D(GL_TEXTURE_2D,0,GL_RGBA8,width,height,0,
+                         GL_RGBA,GL_UNSIGNED_BYTE,nullptr);
+            glBindTexture(GL_TEXTURE_2D,0);
+
+            glBindRenderbuffer(GL_RENDERBUFFER,slot.depth_stencil_rb);
+            glRenderbufferStorage(GL_RENDERBUFFER,GL_DEPTH24_STENCIL8,
+                                  width,height);
+            glBindRenderbuffer(GL_RENDERBUFFER,0);
+        }
+
+        void PresentThreadSDL::acquireSlot()
+        {
+            // Expects m_mutex to be locked; with at most one slot
+            // presenting and one ready there's always a free one
+            for(uint i=0; i < m_list_slots.size(); i++) {
+                if(m_list_slots[i].state == State::Free) {
+                    m_list_slots[i].state = State::Rendering;
+                    m_rendering = i;
+                    return;
+                }
+            }
+        }
+
+        void PresentThreadSDL::present()
+        {
+#ifdef KS_ENV_ANDROID
+            Android_JNI_SetupThread();
+#endif
+            {
+                ThreadQoS::Result qos_result = ThreadQoS::Apply(m_qos);
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_qos_result = std::move(qos_result);
+            }
+
+            if(SDL_GL_MakeCurrent(m_window,m_window_context) != 0) {
+                LOG.Warn() << "PresentThreadSDL: Failed to make "
+                              "window context current: " << SDL_GetError();
+
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_failed = true;
+                return;
+            }
+
+            if(SDL_GL_SetSwapInterval(m_swap_interval) != 0) {
+                LOG.Warn() << "PresentThreadSDL: Failed to set swap "
+                              "interval: " << SDL_GetError();
+            }
+
+            // Framebuffers aren't shared between contexts so the
+            // present context needs its own to read the textures
+            for(auto& slot : m_list_slots) {
+                glGenFramebuffers(1,&slot.present_fbo);
+                glBindFramebuffer(GL_READ_FRAMEBUFFER,slot.present_fbo);
+                glFramebufferTexture2D(GL_READ_FRAMEBUFFER,
+                                       GL_COLOR_ATTACHMENT0,
+                                       GL_TEXTURE_2D,
+                                       slot.texture,
+                                       0);
+            }
+
+            for(;;) {
+                sint index;
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_cv.wait(lock,[this](){
+                        return (m_stop || m_ready >= 0);
+                    });
+
+                    if(m_stop) {
+                        break;
+                    }
+
+                    if(m_presenting >= 0) {
+                        m_list_slots[m_presenting].state = State::Free;
+                    }
+
+                    index = m_ready;
+                    m_ready = -1;
+                    m_list_slots[index].state = State::Presenting;
+                    m_presenting = index;
+                }
+
+                Slot& slot = m_list_slots[index];
+
+                glWaitSync(slot.render_fence,0,GL_TIMEOUT_IGNORED);
+                glDeleteSync(slot.render_fence);
+                slot.render_fence = nullptr;
+
+                int width,height;
+                SDL_GL_GetDrawableSize(m_window,&width,&height);
+
+                glBindFramebuffer(GL_READ_FRAMEBUFFER,slot.present_fbo);
+                glBindFramebuffer(GL_DRAW_FRAMEBUFFER,0);
+                glBlitFramebuffer(0,0,slot.width,slot.height,
+                                  0,0,width,height,
+                                  GL_COLOR_BUFFER_BIT,
+                                  GL_LINEAR);
+
+                // Swapping flushes, so the fence will be
+                // visible to the render context
+                slot.read_fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE,0);
+
+                SDL_GL_SwapWindow(m_window);
+                m_presented++;
+            }
+
+            glBindFramebuffer(GL_READ_FRAMEBUFFER,0);
+            for(auto& slot : m_list_slots) {
+                glDeleteFramebuffers(1,&slot.present_fbo);
+                slot.present_fbo = 0;
+            }
+            glFinish();
+
+            SDL_GL_MakeCurrent(m_window,nullptr);
+        }
+    }
+}
@@ -0,0 +1,180 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef KS_GUI_PRESENT_THREAD_SDL_HPP
+#define KS_GUI_PRESENT_THREAD_SDL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <ks/gl/KsGLConfig.hpp>
+
+#include <SDL2/SDL.h>
+
+#include <ks/gui/KsGuiPlatform.hpp>
+#include <ks/platform/sdl/KsGuiThreadQoSSDL.hpp>
+
+namespace ks
+{
+    namespace gui
+    {
+        // PresentThreadSDL
+        // * Moves presentation off of the render thread: frames
+        //   are rendered into a ring of offscreen framebuffers and
+        //   a present thread that owns the window's context blits
+        //   the newest finished frame to the window and swaps
+        // * Works like a mailbox; a finished frame replaces any
+        //   frame that's still waiting to be presented, so the
+        //   render thread never blocks on vsync and the frame on
+        //   screen is always the newest one available
+        // * The render thread gets its own context, shared with
+        //   the window's and made current on a hidden window since
+        //   some platforms (ie. EGL) don't allow a window surface
+        //   to be current on two threads at once; this means it
+        //   isn't available where SDL only supports one window
+        //   (ie. Android)
+        // * Created and destroyed on the render thread with the
+        //   window's context current; the render context is left
+        //   current after creation and the window's context
+        //   after destruction
+        // * ring_size is at least 3: one slot presenting, one
+        //   ready and one being rendered into
+        // * qos is applied to the present thread when it starts
+        class PresentThreadSDL final
+        {
+        public:
+            struct Stats
+            {
+                u64 submitted;
+                u64 presented;
+
+                // Frames replaced before they were presented
+                u64 dropped;
+            };
+
+            PresentThreadSDL(SDL_Window* window,
+                             SDL_GLContext window_context,
+                             uint ring_size=3,
+                             ThreadQoS const &qos=ThreadQoS());
+
+            ~PresentThreadSDL();
+
+            SDL_GLContext GetWindowContext() const;
+            SDL_Window* GetRenderWindow() const;
+            SDL_GLContext GetRenderContext() const;
+
+            // Framebuffer to render the current frame into and
+            // its size; both can change after SubmitFrame
+            GLuint GetFramebuffer() const;
+            Window::Size GetRenderSize() const;
+
+            // * Hands the current frame to the present thread and
+            //   binds the framebuffer for the next one
+            // * Never waits on the present thread's gpu work; any
+            //   wait for a reused buffer is queued on the gpu
+            // * Returns false without submitting anything if the
+            //   present thread failed to make the window's context
+            //   current, in which case nothing will ever be
+            //   presented and the caller should stop the thread
+            bool SubmitFrame();
+
+            // Any thread
+            Stats GetStats() const;
+
+            // * Any thread
+            // * The result of applying qos; ok until the thread
+            //   has started
+            ThreadQoS::Result GetQoSResult() const;
+
+            // * Drops the render context's GL objects without
+            //   deleting them, for when the render context can't
+            //   be made current
+            // * The objects are leaked; the destructor still stops
+            //   the present thread and deletes the render context
+            void ForgetGLObjects();
+
+        private:
+            enum class State
+            {
+                Free,
+                Rendering,
+                Ready,
+                Presenting
+            };
+
+            struct Slot
+            {
+                State state{State::Free};
+
+                // Render context
+                GLuint texture{0};
+                GLuint depth_stencil_rb{0};
+                GLuint fbo{0};
+                uint width{0};
+                uint height{0};
+
+                // Signaled when rendering into the slot is done
+                GLsync render_fence{nullptr};
+
+                // Signaled when the present thread is done
+                // reading from the slot
+                GLsync read_fence{nullptr};
+
+                // Present context
+                GLuint present_fbo{0};
+            };
+
+            void resizeSlot(Slot& slot, uint width, uint height);
+            void acquireSlot();
+            void present();
+
+            SDL_Window* const m_window;
+            SDL_GLContext const m_window_context;
+            SDL_Window* m_render_window;
+            SDL_GLContext m_render_context;
+            int m_swap_interval;
+            ThreadQoS const m_qos;
+            bool m_gl_forgotten;
+
+            std::vector<Slot> m_list_slots;
+
+            // Only accessed by the render thread
+            uint m_rendering;
+
+            // Guarded by m_mutex along with each Slot::state
+            mutable std::mutex m_mutex;
+            std::condition_variable m_cv;
+            bool m_stop;
+            sint m_ready;
+            bool m_failed;
+            ThreadQoS::Result m_qos_result;
+
+            // Only accessed by the present thread
+            sint m_presenting;
+
+            std::atomic<u64> m_submitted;
+            std::atomic<u64> m_presented;
+            std::atomic<u64> m_dropped;
+
+            std::thread m_thread;
+        };
+    }
+}
+
+#endif // KS_GUI_PRESENT_THREAD_SDL_HPP
@@ -0,0 +1,162 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <cerrno>
+#include <cstring>
+
+#include <SDL2/SDL.h>
+
+#include <ks/KsLog.hpp>
+#include <ks/platform/sdl/KsGuiThreadQoSSDL.hpp>
+
+#ifdef KS_ENV_LINUX
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace ks
+{
+    namespace gui
+    {
+        namespace
+        {
+            void addError(ThreadQoS::Result &result, std::string const &error)
+            {
+                if(!result.error.empty()) {
+                    result.error += "; ";
+                }
+                result.error += error;
+                result.ok = false;
+            }
+
+            void applyPriority(ThreadQoS const &qos, ThreadQoS::Result &result)
+            {
+                SDL_ThreadPriority sdl_priority;
+                switch(qos.priority)
+                {
+                    case ThreadQoS::Priority::Default:
+                        return;
+                    case ThreadQoS::Priority::Low:
+                        sdl_priority = SDL_THREAD_PRIORITY_LOW;
+                        break;
+                    case ThreadQoS::Priority::Normal:
+                        sdl_priority = SDL_THREAD_PRIORITY_NORMAL;
+                        break;
+                    case ThreadQoS::Priority::High:
+                        sdl_priority = SDL_THREAD_PRIORITY_HIGH;
+                        break;
+                    case ThreadQoS::Priority::TimeCritical:
+#if SDL_VERSION_ATLEAST(2,0,9)
+                        sdl_priority = SDL_THREAD_PRIORITY_TIME_CRITICAL;
+#else
+                        sdl_priority = SDL_THREAD_PRIORITY_HIGH;
+#endif
+                        break;
+                }
+
+                if(SDL_SetThreadPriority(sdl_priority) != 0) {
+                    addError(result,std::string("priority: ")+SDL_GetError());
+                }
+            }
+
+            void applyPolicy(ThreadQoS const &qos, ThreadQoS::Result &result)
+            {
+                if(qos.policy == ThreadQoS::Policy::Default) {
+                    return;
+                }
+
+#ifdef KS_ENV_LINUX
+                int policy = SCHED_OTHER;
+                switch(qos.policy)
+                {
+                    case ThreadQoS::Policy::Default:
+                    case ThreadQoS::Policy::Other:
+                        policy = SCHED_OTHER;
+                        break;
+                    case ThreadQoS::Policy::Batch:
+                        policy = SCHED_BATCH;
+                        break;
+                    case ThreadQoS::Policy::Idle:
+                        policy = SCHED_IDLE;
+                        break;
+                    case ThreadQoS::Policy::Fifo:
+                        policy = SCHED_FIFO;
+                        break;
+                    case ThreadQoS::Policy::RoundRobin:
+                        policy = SCHED_RR;
+                        break;
+                }
+
+                struct sched_param param;
+                std::memset(&param,0,sizeof(param));
+                if(policy == SCHED_FIFO || policy == SCHED_RR) {
+                    param.sched_priority = qos.realtime_priority;
+                }
+
+                // On Linux a pid of 0 is the calling thread
+                if(sched_setscheduler(0,policy,&param) != 0) {
+                    addError(result,std::string("policy: ")+std::strerror(errno));
+                }
+#else
+                addError(result,"policy: unsupported on this platform");
+#endif
+            }
+
+            void applyAffinity(ThreadQoS const &qos, ThreadQoS::Result &result)
+            {
+                if(qos.list_cpus.empty()) {
+                    return;
+                }
+
+#ifdef KS_ENV_LINUX
+                cpu_set_t cpu_set;
+                CPU_ZERO(&cpu_set);
+                for(uint const cpu : qos.list_cpus) {
+                    if(cpu >= CPU_SETSIZE) {
+                        addError(result,"affinity: invalid cpu "+std::to_string(cpu));
+                        return;
+                    }
+                    CPU_SET(cpu,&cpu_set);
+                }
+
+                int const err = pthread_setaffinity_np(pthread_self(),
+                                                       sizeof(cpu_set),
+                                                       &cpu_set);
+                if(err != 0) {
+                    addError(result,std::string("affinity: ")+std::strerror(err));
+                }
+#else
+                addError(result,"affinity: unsupported on this platform");
+#endif
+            }
+        }
+
+        ThreadQoS::Result ThreadQoS::Apply(ThreadQoS const &qos)
+        {
+            Result result;
+
+            applyPriority(qos,result);
+            applyPolicy(qos,result);
+            applyAffinity(qos,result);
+
+            if(!result.ok) {
+                LOG.Warn() << "ThreadQoS: Failed to apply: " << result.error;
+            }
+
+            return result;
+        }
+    }
+}
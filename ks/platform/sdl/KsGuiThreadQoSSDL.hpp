@@ -0,0 +1,83 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef KS_GUI_THREAD_QOS_SDL_HPP
+#define KS_GUI_THREAD_QOS_SDL_HPP
+
+#include <string>
+#include <vector>
+
+#include <ks/KsGlobal.hpp>
+
+namespace ks
+{
+    namespace gui
+    {
+        // ThreadQoS
+        // * Scheduling settings for a thread: a priority class set
+        //   through SDL_SetThreadPriority, and on Linux a scheduling
+        //   policy and the cpus the thread may run on
+        // * Each setting left at its default is not changed
+        // * The policy is applied after the priority class, so an
+        //   explicit policy replaces whatever SDL chose for it
+        // * Raising the priority or using a realtime policy usually
+        //   needs privileges (CAP_SYS_NICE or an rtprio limit); the
+        //   settings that fail are reported in Result, the rest
+        //   are still applied
+        struct ThreadQoS
+        {
+            enum class Priority
+            {
+                Default,
+                Low,
+                Normal,
+                High,
+                TimeCritical
+            };
+
+            enum class Policy
+            {
+                Default,
+                Other,
+                Batch,
+                Idle,
+                Fifo,
+                RoundRobin
+            };
+
+            struct Result
+            {
+                bool ok{true};
+                std::string error;
+            };
+
+            Priority priority{Priority::Default};
+            Policy policy{Policy::Default};
+
+            // Only used with Fifo and RoundRobin (1-99 on Linux)
+            sint realtime_priority{1};
+
+            // Empty to leave the affinity unchanged
+            std::vector<uint> list_cpus;
+
+            // Applies qos to the calling thread; failures are
+            // also logged
+            static Result Apply(ThreadQoS const &qos);
+        };
+    }
+}
+
+#endif // KS_GUI_THREAD_QOS_SDL_HPP
@@ -0,0 +1,162 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <ks/platform/sdl/KsGuiTouchTrackerSDL.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define KS_TOUCH_TRACKER_SSE2
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #define KS_TOUCH_TRACKER_NEON
+    #include <arm_neon.h>
+#endif
+
+namespace ks
+{
+    namespace gui
+    {
+        static_assert(TouchTrackerSDL::MaxTouches % 4 == 0,
+                      "TouchTrackerSDL: MaxTouches must be a multiple of 4");
+
+        static_assert(TouchTrackerSDL::MaxTouches <= 32,
+                      "TouchTrackerSDL: MaxTouches must fit in a u32 mask");
+
+        TouchTrackerSDL::TouchTrackerSDL() :
+            m_frame(0),
+            m_used_mask(0),
+            m_active_mask(0),
+            m_pressed_mask(0),
+            m_released_mask(0)
+        {
+            m_list_touch_ids.fill(0);
+            m_list_finger_ids.fill(0);
+            m_norm_x.fill(0.0f);
+            m_norm_y.fill(0.0f);
+            m_pressure.fill(0.0f);
+        }
+
+        void TouchTrackerSDL::BeginFrame()
+        {
+            // Slots released last frame become free
+            m_used_mask &= ~m_released_mask;
+
+            m_pressed_mask = 0;
+            m_released_mask = 0;
+        }
+
+        sint TouchTrackerSDL::ProcessEvent(SDL_TouchFingerEvent const &sdl_event)
+        {
+            // Find the slot already used by this contact
+            sint slot = -1;
+            for(uint i=0; i < MaxTouches; i++) {
+                if((m_active_mask & (1u << i)) &&
+                   m_list_finger_ids[i] == sdl_event.fingerId &&
+                   m_list_touch_ids[i] == sdl_event.touchId) {
+                    slot = i;
+                    break;
+                }
+            }
+
+            if(sdl_event.type == SDL_FINGERDOWN && slot < 0) {
+                // Take the lowest free slot
+                for(uint i=0; i < MaxTouches; i++) {
+                    if((m_used_mask & (1u << i)) == 0) {
+                        slot = i;
+                        break;
+                    }
+                }
+
+                if(slot < 0) {
+                    return -1;
+                }
+
+                u32 const bit = (1u << slot);
+                m_used_mask |= bit;
+                m_active_mask |= bit;
+                m_pressed_mask |= bit;
+                m_list_touch_ids[slot] = sdl_event.touchId;
+                m_list_finger_ids[slot] = sdl_event.fingerId;
+            }
+
+            if(slot < 0) {
+                return -1;
+            }
+
+            m_norm_x[slot] = sdl_event.x;
+            m_norm_y[slot] = sdl_event.y;
+            m_pressure[slot] = sdl_event.pressure;
+
+            if(sdl_event.type == SDL_FINGERUP) {
+                u32 const bit = (1u << slot);
+                m_active_mask &= ~bit;
+                m_released_mask |= bit;
+            }
+
+            return slot;
+        }
+
+        void TouchTrackerSDL::EndFrame(float width_px, float height_px)
+        {
+            m_frame++;
+
+            m_snapshot.frame = m_frame;
+            m_snapshot.active_mask = m_active_mask;
+            m_snapshot.pressed_mask = m_pressed_mask;
+            m_snapshot.released_mask = m_released_mask;
+
+            // Nothing has been touched since the last
+            // conversion so the pixel values are current
+            if(m_used_mask == 0 && m_released_mask == 0) {
+                return;
+            }
+
+            convertToPixels(width_px,height_px);
+            m_snapshot.pressure = m_pressure;
+        }
+
+        TouchTrackerSDL::Snapshot const & TouchTrackerSDL::GetSnapshot() const
+        {
+            return m_snapshot;
+        }
+
+        void TouchTrackerSDL::convertToPixels(float width_px, float height_px)
+        {
+            float const * norm_x = m_norm_x.data();
+            float const * norm_y = m_norm_y.data();
+            float * x = m_snapshot.x.data();
+            float * y = m_snapshot.y.data();
+
+#if defined(KS_TOUCH_TRACKER_SSE2)
+            __m128 const w = _mm_set1_ps(width_px);
+            __m128 const h = _mm_set1_ps(height_px);
+            for(uint i=0; i < MaxTouches; i+=4) {
+                _mm_storeu_ps(x+i,_mm_mul_ps(_mm_loadu_ps(norm_x+i),w));
+                _mm_storeu_ps(y+i,_mm_mul_ps(_mm_loadu_ps(norm_y+i),h));
+            }
+#elif defined(KS_TOUCH_TRACKER_NEON)
+            for(uint i=0; i < MaxTouches; i+=4) {
+                vst1q_f32(x+i,vmulq_n_f32(vld1q_f32(norm_x+i),width_px));
+                vst1q_f32(y+i,vmulq_n_f32(vld1q_f32(norm_y+i),height_px));
+            }
+#else
+            for(uint i=0; i < MaxTouches; i++) {
+                x[i] = norm_x[i]*width_px;
+                y[i] = norm_y[i]*height_px;
+            }
+#endif
+        }
+    }
+}
@@ -0,0 +1,103 @@
+/*
+   Copyright (C) 2016 Preet Desai (preet.desai@gmail.com)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef KS_GUI_TOUCH_TRACKER_SDL_HPP
+#define KS_GUI_TOUCH_TRACKER_SDL_HPP
+
+#include <array>
+
+#include <SDL2/SDL.h>
+
+#include <ks/KsGlobal.hpp>
+
+namespace ks
+{
+    namespace gui
+    {
+        // TouchTrackerSDL
+        // * Tracks active touch contacts across frames
+        // * Each contact is given the lowest free slot when it's
+        //   pressed and keeps it until the frame after it's
+        //   released, so slot numbers are small and stable and
+        //   can be used as a TouchEvent index (unlike SDL's
+        //   64-bit finger ids)
+        // * Positions and pressure are stored per slot in
+        //   separate arrays and normalized positions are
+        //   converted to pixels for all slots at once
+        class TouchTrackerSDL final
+        {
+        public:
+            // Must be a multiple of 4 for the batch conversion
+            static uint const MaxTouches = 16;
+
+            struct Snapshot
+            {
+                u64 frame{0};
+
+                // Bit n corresponds to slot n
+                // * active: contacts that are down
+                // * pressed: contacts that went down this frame
+                // * released: contacts that went up this frame;
+                //   their last position is still valid
+                u32 active_mask{0};
+                u32 pressed_mask{0};
+                u32 released_mask{0};
+
+                // Pixel positions and pressure in [0,1]
+                std::array<float,MaxTouches> x{};
+                std::array<float,MaxTouches> y{};
+                std::array<float,MaxTouches> pressure{};
+            };
+
+            TouchTrackerSDL();
+
+            // Frees slots released during the previous
+            // frame and clears per-frame state
+            void BeginFrame();
+
+            // Returns the slot for the event's contact, or
+            // -1 if the contact isn't tracked (no free slots
+            // or motion/release for an unknown contact)
+            sint ProcessEvent(SDL_TouchFingerEvent const &sdl_event);
+
+            // Converts the positions of all slots to pixels
+            // and updates the snapshot
+            void EndFrame(float width_px, float height_px);
+
+            Snapshot const & GetSnapshot() const;
+
+        private:
+            void convertToPixels(float width_px, float height_px);
+
+            u64 m_frame;
+            u32 m_used_mask;
+            u32 m_active_mask;
+            u32 m_pressed_mask;
+            u32 m_released_mask;
+
+            std::array<SDL_TouchID,MaxTouches> m_list_touch_ids;
+            std::array<SDL_FingerID,MaxTouches> m_list_finger_ids;
+
+            std::array<float,MaxTouches> m_norm_x;
+            std::array<float,MaxTouches> m_norm_y;
+            std::array<float,MaxTouches> m_pressure;
+
+            Snapshot m_snapshot;
+        };
+    }
+}
+
+#endif // KS_GUI_TOUCH_TRACKER_SDL_HPP
@@ -12,10 +12,42 @@ count(PATH_SDL_INCLUDE,0) {
 
 HEADERS += \
     $${PATH_KS_PLATFORM}/KsPlatformOpts.hpp \
-    $${PATH_KS_PLATFORM}/KsPlatformMain.hpp
+    $${PATH_KS_PLATFORM}/KsPlatformMain.hpp \
+    $${PATH_KS_PLATFORM}/KsPlatformSnapshotBuffer.hpp \
+    $${PATH_KS_PLATFORM}/KsPlatformMPSCQueue.hpp \
+    $${PATH_KS_PLATFORM}/sdl/KsGuiPlatformSDL.hpp \
+    $${PATH_KS_PLATFORM}/sdl/KsGuiGameControllerSDL.hpp \
+    $${PATH_KS_PLATFORM}/sdl/KsGuiTouchTrackerSDL.hpp \
+    $${PATH_KS_PLATFORM}/sdl/KsGuiGestureRecognizerSDL.hpp \
+    $${PATH_KS_PLATFORM}/sdl/KsGuiInputStateSDL.hpp \
+    $${PATH_KS_PLATFORM}/sdl/KsGuiEventMetricsSDL.hpp \
+    $${PATH_KS_PLATFORM}/sdl/KsGuiGLFunctionLoaderSDL.hpp \
+    $${PATH_KS_PLATFORM}/KsPlatformFrameCapture.hpp \
+    $${PATH_KS_PLATFORM}/KsPlatformStaticDispatch.hpp \
+    $${PATH_KS_PLATFORM}/KsPlatformResolutionScaler.hpp \
+    $${PATH_KS_PLATFORM}/sdl/KsGuiPresentThreadSDL.hpp \
+    $${PATH_KS_PLATFORM}/sdl/KsGuiFrameLoopSDL.hpp \
+    $${PATH_KS_PLATFORM}/KsPlatformVblankEstimator.hpp \
+    $${PATH_KS_PLATFORM}/sdl/KsGuiThreadQoSSDL.hpp \
+    $${PATH_KS_PLATFORM}/KsPlatformFileMapLoader.hpp
+
+ks_platform_static_dispatch {
+    DEFINES += KS_PLATFORM_STATIC_DISPATCH
+}
 
 SOURCES += \
-    $${PATH_KS_PLATFORM}/sdl/KsGuiPlatformSDL.cpp
+    $${PATH_KS_PLATFORM}/sdl/KsGuiPlatformSDL.cpp \
+    $${PATH_KS_PLATFORM}/sdl/KsGuiGameControllerSDL.cpp \
+    $${PATH_KS_PLATFORM}/sdl/KsGuiTouchTrackerSDL.cpp \
+    $${PATH_KS_PLATFORM}/sdl/KsGuiGestureRecognizerSDL.cpp \
+    $${PATH_KS_PLATFORM}/sdl/KsGuiGLFunctionLoaderSDL.cpp \
+    $${PATH_KS_PLATFORM}/KsPlatformFrameCapture.cpp \
+    $${PATH_KS_PLATFORM}/KsPlatformResolutionScaler.cpp \
+    $${PATH_KS_PLATFORM}/sdl/KsGuiPresentThreadSDL.cpp \
+    $${PATH_KS_PLATFORM}/sdl/KsGuiFrameLoopSDL.cpp \
+    $${PATH_KS_PLATFORM}/KsPlatformVblankEstimator.cpp \
+    $${PATH_KS_PLATFORM}/sdl/KsGuiThreadQoSSDL.cpp \
+    $${PATH_KS_PLATFORM}/KsPlatformFileMapLoader.cpp
 
 linux {
     !android {